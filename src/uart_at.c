@@ -0,0 +1,180 @@
+/**
+ * @file uart_at.c
+ * @author Roberto Parra (uedsoldier1990@gmail.com)
+ * @brief
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include <string.h>
+#include "uart_at.h"
+
+/*
+ * Every pattern is stored in the trie after an implicit '\n', so matches are anchored at line start. Root
+ * is state 0 and state 1 is the line start ('\n'). Failure links are only used while building: missing
+ * transitions are filled with the transition of the failure state (breadth first), so matching never
+ * backtracks and partial matches are just the current state.
+ */
+
+/**
+ * @brief Class of a byte, allocating a new one the first time it's used
+ * @return uint8_t Byte class, 0 if out of classes
+ */
+static uint8_t uart_atClass(UARTAtMatcher *matcher, uint8_t byte, uint8_t *classCount)
+{
+    if (matcher->classes[byte] == 0)
+    {
+        if (*classCount == UART_AT_MAX_CLASSES)
+            return 0;
+        matcher->classes[byte] = (*classCount)++;
+    }
+    return matcher->classes[byte];
+}
+
+/**
+ * @brief Reports a completed pattern: URCs go to their handler, final responses are returned
+ * @return int Final response pattern index, or UART_AT_NONE
+ */
+static int uart_atComplete(UARTAtMatcher *matcher, uint8_t pattern)
+{
+    const UARTAtPattern *entry = &matcher->patterns[pattern];
+    matcher->argument[matcher->argumentLen] = '\0';
+    if (entry->urc == NULL)
+        return pattern;
+    entry->urc(matcher->context, pattern, matcher->argument, matcher->argumentLen);
+    return UART_AT_NONE;
+}
+
+bool uart_atInit(UARTAtMatcher *matcher, const UARTAtPattern *patterns, uint8_t count, void *context)
+{
+    uint8_t fail[UART_AT_MAX_STATES];
+    uint8_t queue[UART_AT_MAX_STATES];
+    uint8_t classCount = 1;
+    unsigned states = 2;
+
+    memset(matcher->classes, 0, sizeof(matcher->classes));
+    memset(matcher->next, 0, sizeof(matcher->next));
+    memset(matcher->output, 0, sizeof(matcher->output));
+    matcher->patterns = patterns;
+    matcher->count = count;
+    matcher->context = context;
+    matcher->lineStart = 1;
+    matcher->next[0][uart_atClass(matcher, '\n', &classCount)] = 1;
+
+    // Trie: 0 marks a missing transition, as no state goes back to the root
+    for (uint8_t i = 0; i != count; i++)
+    {
+        const uint8_t *text = (const uint8_t *)patterns[i].text;
+        uint8_t state = 1;
+        if (*text == '\0')
+            return false;
+        for (; *text != '\0'; text++)
+        {
+            uint8_t c = uart_atClass(matcher, *text, &classCount);
+            if (c == 0)
+                return false;
+            if (matcher->next[state][c] == 0)
+            {
+                if (states == UART_AT_MAX_STATES)
+                    return false;
+                matcher->next[state][c] = (uint8_t)states++;
+            }
+            state = matcher->next[state][c];
+        }
+        if (matcher->output[state] == 0)
+            matcher->output[state] = (uint8_t)(i + 1);
+    }
+
+    // Breadth first: fill missing transitions through failure links and inherit outputs of failure states
+    unsigned head = 0, tail = 0;
+    fail[1] = 0;
+    queue[tail++] = 1;
+    while (head != tail)
+    {
+        uint8_t state = queue[head++];
+        for (uint8_t c = 0; c != classCount; c++)
+        {
+            uint8_t child = matcher->next[state][c];
+            uint8_t fallback = (state == 0) ? 0 : matcher->next[fail[state]][c];
+            if (child == 0)
+            {
+                matcher->next[state][c] = fallback;
+                continue;
+            }
+            fail[child] = fallback;
+            if (matcher->output[child] == 0)
+                matcher->output[child] = matcher->output[fallback];
+            queue[tail++] = child;
+        }
+    }
+    uart_atReset(matcher);
+    return true;
+}
+
+void uart_atReset(UARTAtMatcher *matcher)
+{
+    matcher->state = matcher->lineStart;
+    matcher->pending = UART_AT_NONE;
+    matcher->argumentLen = 0;
+}
+
+size_t uart_atFeed(UARTAtMatcher *matcher, const uint8_t *data, size_t len, int *response)
+{
+    uint8_t state = matcher->state;
+    size_t i = 0;
+    *response = UART_AT_NONE;
+    while (i != len)
+    {
+        uint8_t byte = data[i++];
+        if (matcher->pending != UART_AT_NONE)
+        {
+            // Capturing the rest of a matched line
+            if (byte == '\n')
+            {
+                uint8_t pattern = (uint8_t)matcher->pending;
+                matcher->pending = UART_AT_NONE;
+                state = matcher->lineStart;
+                *response = uart_atComplete(matcher, pattern);
+                if (*response != UART_AT_NONE)
+                    break;
+            }
+            else if (byte != '\r' && matcher->argumentLen < UART_AT_ARGUMENT_SIZE - 1)
+            {
+                matcher->argument[matcher->argumentLen++] = (char)byte;
+            }
+            continue;
+        }
+        state = matcher->next[state][matcher->classes[byte]];
+        if (matcher->output[state] != 0)
+        {
+            uint8_t pattern = (uint8_t)(matcher->output[state] - 1);
+            matcher->argumentLen = 0;
+            if (matcher->patterns[pattern].argument)
+            {
+                matcher->pending = pattern;
+                continue;
+            }
+            *response = uart_atComplete(matcher, pattern);
+            if (*response != UART_AT_NONE)
+                break;
+        }
+    }
+    matcher->state = state;
+    return i;
+}
+
+int uart_atRead(UART_BUFFER_PARAM UARTAtMatcher *matcher)
+{
+    UARTSpan spans[2];
+    int response;
+    if (uart_peek(UART_BUFFER_ARG(uartBuffer) spans) == 0)
+        return UART_AT_NONE;
+    size_t used = uart_atFeed(matcher, spans[0].data, spans[0].len, &response);
+    if (response == UART_AT_NONE && spans[1].len != 0)
+        used += uart_atFeed(matcher, spans[1].data, spans[1].len, &response);
+    uart_consume(UART_BUFFER_ARG(uartBuffer) used);
+    return response;
+}
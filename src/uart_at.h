@@ -0,0 +1,135 @@
+/**
+ * @file uart_at.h
+ * @author Roberto Parra (uedsoldier1990@gmail.com)
+ * @brief Streaming AT response and URC matcher over the UART buffer RX stream
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef UART_AT_H
+#define UART_AT_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#pragma region Dependencies
+#include "uart_buffer.h"
+#pragma endregion
+
+/**
+ * @brief Maximum automaton state quantity: one per distinct pattern prefix, plus the root and line start
+ * (sum of pattern lengths + 2 is always enough). Up to 256
+ */
+#ifndef UART_AT_MAX_STATES
+#define UART_AT_MAX_STATES 128
+#endif
+
+#if (UART_AT_MAX_STATES < 2) || (UART_AT_MAX_STATES > 256)
+#error "UART_AT_MAX_STATES must be between 2 and 256"
+#endif
+
+/**
+ * @brief Maximum byte class quantity: one per distinct byte used in patterns, plus '\n' and one for all
+ * other bytes. Transition table size is UART_AT_MAX_STATES * UART_AT_MAX_CLASSES bytes
+ */
+#ifndef UART_AT_MAX_CLASSES
+#define UART_AT_MAX_CLASSES 32
+#endif
+
+#if (UART_AT_MAX_CLASSES < 2) || (UART_AT_MAX_CLASSES > 256)
+#error "UART_AT_MAX_CLASSES must be between 2 and 256"
+#endif
+
+/**
+ * @brief Storage for the rest of a matched line ('\r' removed, longer lines are truncated)
+ */
+#ifndef UART_AT_ARGUMENT_SIZE
+#define UART_AT_ARGUMENT_SIZE 64
+#endif
+
+/**
+ * @brief No response matched
+ */
+#define UART_AT_NONE (-1)
+
+/**
+ * @brief Pattern definition. Patterns only match at the start of a line (right after '\n'). A pattern that
+ * is a prefix of another one completes first and hides it
+ */
+typedef struct _UARTAtPattern{
+    const char *text;       // Pattern text, e.g. "OK\r\n", "+CME ERROR:", "> "
+    bool argument;          // Capture the rest of the line and report the pattern at end of line
+    void (*urc)(void *context, uint8_t pattern, const char *argument, size_t len);  // Unsolicited result code handler (NULL: final response)
+} UARTAtPattern;
+
+/**
+ * @brief Matcher state. The transition table is a deterministic Aho-Corasick automaton: every received
+ * byte costs one class lookup and one table lookup, whatever the pattern quantity
+ */
+typedef struct _UARTAtMatcher{
+    const UARTAtPattern *patterns;
+    uint8_t count;
+    void *context;                  // Passed to URC handlers
+    uint8_t classes[256];           // Byte class of every byte value (0: not used in any pattern)
+    uint8_t next[UART_AT_MAX_STATES][UART_AT_MAX_CLASSES];
+    uint8_t output[UART_AT_MAX_STATES];     // Pattern index + 1 matched when entering a state, 0 if none
+    uint8_t lineStart;              // State after '\n'
+    uint8_t state;
+    int16_t pending;                // Pattern capturing its argument, or UART_AT_NONE
+    char argument[UART_AT_ARGUMENT_SIZE];
+    size_t argumentLen;
+} UARTAtMatcher;
+
+#pragma region Function prototypes
+
+/**
+ * @brief Builds the matcher automaton (once, patterns are referenced and must stay valid)
+ * @param matcher Reference to matcher
+ * @param patterns Pattern array
+ * @param count Pattern quantity (up to 255)
+ * @param context User data passed to URC handlers
+ * @return true Matcher built
+ * @return false Empty pattern, or UART_AT_MAX_STATES/UART_AT_MAX_CLASSES too small
+ */
+bool uart_atInit(UARTAtMatcher *matcher, const UARTAtPattern *patterns, uint8_t count, void *context);
+
+/**
+ * @brief Discards any partial match, as if a line had just started (e.g. before sending a command)
+ * @param matcher Reference to matcher
+ */
+void uart_atReset(UARTAtMatcher *matcher);
+
+/**
+ * @brief Runs a chunk of received data through the matcher, dispatching URCs and stopping right after the
+ * first final response. Partial matches carry over to the next call
+ * @param matcher Reference to matcher
+ * @param data Received data
+ * @param len Received data length
+ * @param response Reference to store the final response pattern index (UART_AT_NONE if none completed).
+ * Its argument stays in matcher->argument until the next call
+ * @return size_t Bytes processed
+ */
+size_t uart_atFeed(UARTAtMatcher *matcher, const uint8_t *data, size_t len, int *response);
+
+/**
+ * @brief Non-blocking response reception. Runs received data through the matcher in place (both ring
+ * spans, no copy) and removes it from UART buffer up to the first final response, so data following it
+ * (e.g. after a "> " prompt) stays in UART buffer
+ * @param uartBuffer Reference to UART buffer (parameter only present with UART_MULTIPLE_BUFFERS)
+ * @param matcher Reference to matcher
+ * @return int Final response pattern index, or UART_AT_NONE if none completed yet
+ */
+int uart_atRead(UART_BUFFER_PARAM UARTAtMatcher *matcher);
+
+#pragma endregion
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*UART_AT_H*/
@@ -12,415 +12,1316 @@
 #include "uart_buffer.h"
 #include "logger.h"
 #include "AT.h"
+#if defined(UART_BUFFER_CAPTURE) && (UART_BUFFER_CAPTURE > 0)
+#include "uart_capture.h"
+#endif
+#if defined(UART_BUFFER_LOG) && (UART_BUFFER_LOG > 0)
+#include <stdio.h>
+#include "uart_trace.h"
+#endif
 
-#if defined(UART_MULTIPLE_BUFFERS) && (UART_MULTIPLE_BUFFERS > 0)
-void uart_buffer_init(UARTBuffer *uartBuffer, void (*writeByte_callback)(uint8_t), uint8_t (*readByte_callback)(void))
-{
-    memset(uartBuffer->rxBuffer, 0, UART_RX_BUFFER_SIZE);
-    uartBuffer->queueFront = -1;
-    uartBuffer->queueEnd = -1;
-    uartBuffer->writeByte = writeByte_callback;
-    uartBuffer->readByte = readByte_callback;
-}
+/*
+ * Statistics counters, compiled out unless UART_BUFFER_STATS is set
+ */
+#if defined(UART_BUFFER_STATS) && (UART_BUFFER_STATS > 0)
+#define UART_STATS_ADD(buffer, counter, value) ((buffer)->stats.counter += (uint32_t)(value))
+#define UART_STATS_PEAK(buffer, used) do { if ((uint32_t)(used) > (buffer)->stats.rxPeak) (buffer)->stats.rxPeak = (uint32_t)(used); } while (0)
 #else
-void uart_buffer_init(void (*writeByte_callback)(uint8_t), uint8_t (*readByte_callback)(void)){
-    memset(uartBuffer.rxBuffer, 0, UART_RX_BUFFER_SIZE);
-    uartBuffer.queueFront = -1;
-    uartBuffer.queueEnd = -1;
-    uartBuffer.writeByte = writeByte_callback;
-    uartBuffer.readByte = readByte_callback;
-}
+#define UART_STATS_ADD(buffer, counter, value) ((void)0)
+#define UART_STATS_PEAK(buffer, used) ((void)0)
 #endif
 
-#if defined(UART_MULTIPLE_BUFFERS) && (UART_MULTIPLE_BUFFERS > 0)
-void uart_puts(UARTBuffer *uartBuffer, const char *str)
+/*
+ * Running CRCs, compiled out unless UART_BUFFER_CRC is set
+ */
+#if defined(UART_BUFFER_CRC) && (UART_BUFFER_CRC > 0)
+#define UART_CRC_UPDATE(crc, data, len) do { if ((crc) != NULL) uart_crcUpdate((crc), (const uint8_t *)(data), (len)); } while (0)
+#else
+#define UART_CRC_UPDATE(crc, data, len) ((void)0)
+#endif
+
+/*
+ * Traffic capture, compiled out unless UART_BUFFER_CAPTURE is set
+ */
+#if defined(UART_BUFFER_CAPTURE) && (UART_BUFFER_CAPTURE > 0)
+#define UART_CAPTURE(buffer, data, len) do { if ((buffer)->capture != NULL) uart_captureRecord((buffer)->capture, (data), (len)); } while (0)
+#else
+#define UART_CAPTURE(buffer, data, len) ((void)0)
+#endif
+
+/*
+ * Event trace, compiled out unless UART_BUFFER_LOG is set
+ */
+#if defined(UART_BUFFER_LOG) && (UART_BUFFER_LOG > 0)
+#define UART_TRACE(buffer, event, value) do { if ((buffer)->trace != NULL) uart_traceRecord((buffer)->trace, (buffer)->tracePort, (event), (value)); } while (0)
+#else
+#define UART_TRACE(buffer, event, value) ((void)0)
+#endif
+
+/*
+ * Arrival timestamps, compiled out unless UART_BUFFER_TIMESTAMP is set
+ */
+#if defined(UART_BUFFER_TIMESTAMP) && (UART_BUFFER_TIMESTAMP > 0)
+#define UART_RX_STAMP(buffer, head, len) do { if ((buffer)->rxStamps != NULL) uart_rxStamp((buffer), (head), (len)); } while (0)
+#else
+#define UART_RX_STAMP(buffer, head, len) ((void)0)
+#endif
+
+#if !(defined(UART_MULTIPLE_BUFFERS) && (UART_MULTIPLE_BUFFERS > 0))
+UARTBuffer uartBuffer;
+#endif
+
+/**
+ * @brief Returns how many bytes are ready to be consumed and the current read index. If the interrupt
+ * handler lapped the reader, the oldest bytes are discarded by moving rxTail forward (consumer side only)
+ * @param buffer Reference to UART buffer
+ * @param tail Reference to store current read index
+ * @return uart_index_t Bytes ready to be consumed
+ */
+static inline uart_index_t uart_rxSync(UARTBuffer *buffer, uart_index_t *tail)
 {
-    while (*str)
+    uart_index_t head = UART_LOAD_ACQUIRE(buffer->rxHead);
+    uart_index_t used = (uart_index_t)(head - buffer->rxTail);
+    if (used > buffer->rxSize)
     {
-        uartBuffer->writeByte(*str++);
+        UART_STATS_ADD(buffer, rxOverwritten, used - buffer->rxSize);
+        UART_TRACE(buffer, UART_TRACE_OVERRUN, used - buffer->rxSize);
+        used = buffer->rxSize;
+        UART_STORE_RELEASE(buffer->rxTail, (uart_index_t)(head - buffer->rxSize));
     }
+    *tail = buffer->rxTail;
+    return used;
 }
-#else
-void uart_puts(const char *str)
+
+/**
+ * @brief Drops the oldest of 'count' bytes copied to 'data' from free-running index 'tail' if the interrupt
+ * handler overwrote them during the copy (overwrite policy), so torn or reordered data is never returned
+ * @return size_t Valid bytes, moved to the start of 'data'
+ */
+static inline size_t uart_rxDropLapped(UARTBuffer *buffer, uint8_t *data, uart_index_t tail, size_t count)
 {
-    while (*str)
+    size_t lost = uart_rxLapped(buffer, tail, count);
+    if (lost == 0)
+        return count;
+    UART_STATS_ADD(buffer, rxOverwritten, lost);
+    UART_TRACE(buffer, UART_TRACE_OVERRUN, lost);
+    memmove(data, data + lost, count - lost);
+    return count - lost;
+}
+
+/**
+ * @brief Under overwrite policy, announces that ring positions up to 'end' are about to be written (producer side)
+ */
+static inline void uart_rxClaim(UARTBuffer *buffer, uart_index_t end)
+{
+    if (buffer->overflowPolicy == UART_OVERFLOW_OVERWRITE)
     {
-        uartBuffer.writeByte(*str++);
+        UART_STORE_RELEASE(buffer->rxClaim, end);
+        UART_FENCE_RELEASE();   // Claim is visible before any data written after it
     }
 }
-#endif
 
-#if defined(UART_MULTIPLE_BUFFERS) && (UART_MULTIPLE_BUFFERS > 0)
-char *uart_gets(UARTBuffer *uartBuffer, char *buffer, size_t len)
+/**
+ * @brief Moves rxTail (consumer side) and, under backpressure policy, resumes the peer once fill level
+ * drops to the low watermark
+ */
+static inline void uart_rxSetTail(UARTBuffer *buffer, uart_index_t tail)
 {
-     uint8_t c;
-    size_t i = 0;
-    while(i != len)
+    UART_STORE_RELEASE(buffer->rxTail, tail);
+    if (buffer->flowStopped && uart_rxUsed(buffer) <= buffer->lowWatermark)
     {
-        while(uart_dataAvailable(uartBuffer) == 0){};
-        uart_readByteBuffer(&c);
-        if((char)c=='\r'){
-            buffer[i++] = '\r'; // CR was received
-            while(uart_dataAvailable(uartBuffer) == 0){};
-            uart_readByteBuffer(&c);
-            if((char)c != '\n'){
-                return NULL;    // CR was received, but without a following LF
-            }
-            buffer[i++] = '\n';
-            break;
-        }
-        else if((char)c == '\n'){
-            buffer[i++] = '\n'; // LF received
-            break;
-        }
-        else if((char)c == '\0'){
-            buffer[i++] = '\0'; // '\0' received
-            break;
-        }
-        else{
-            buffer[i++] = (char)c;    // Valid character  
-        }
-        
-    }
-    if(i == len - 1){   // String is too long
-        buffer[i] = '/0';
-        return NULL;
+        buffer->flowStopped = false;
+        buffer->flowControl(false);
     }
-    return buffer;  // Valid string
 }
-#else
-char *uart_gets(char *buffer, size_t len)
+
+/**
+ * @brief Under backpressure policy, asks the peer to stop once fill level reaches the high watermark (producer side)
+ */
+static inline void uart_rxCheckHighWatermark(UARTBuffer *buffer, size_t used)
 {
-    uint8_t c;
-    size_t i = 0;
-    while(i != len)
+    if (buffer->overflowPolicy == UART_OVERFLOW_BACKPRESSURE && !buffer->flowStopped && used >= buffer->highWatermark)
     {
-        while(uart_dataAvailable() == 0){};
-        uart_readByteBuffer(&c);
-        if((char)c=='\r'){
-            buffer[i++] = '\r'; // CR was received
-            while(uart_dataAvailable() == 0){};
-            uart_readByteBuffer(&c);
-            if((char)c != '\n'){
-                return NULL;    // CR was received, but without a following LF
-            }
-            buffer[i++] = '\n';
-            break;
-        }
-        else if((char)c == '\n'){
-            buffer[i++] = '\n'; // LF received
-            break;
-        }
-        else if((char)c == '\0'){
-            buffer[i++] = '\0'; // '\0' received
-            break;
-        }
-        else{
-            buffer[i++] = (char)c;    // Valid character  
-        }
-        
-    }
-    if(i == len - 1){   // String is too long
-        buffer[i] = '\0';
-        return NULL;
+        buffer->flowStopped = true;
+        buffer->flowControl(true);
     }
-    return buffer;  // Valid string
+}
+
+#if (defined(UART_BUFFER_READY) && (UART_BUFFER_READY > 0)) || (defined(UART_BUFFER_EVENTS) && (UART_BUFFER_EVENTS > 0))
+/**
+ * @brief Looks for 'byte' in data published from 'start' to 'head' (at most two memchr calls)
+ */
+static bool uart_rxReceived(UARTBuffer *buffer, uart_index_t start, uart_index_t head, int byte)
+{
+    size_t len = (uart_index_t)(head - start);
+    size_t offset = start & buffer->rxMask;
+    size_t first = (buffer->rxSize - offset < len) ? buffer->rxSize - offset : len;
+    return memchr(&buffer->rxBuffer[offset], byte, first) != NULL || memchr(buffer->rxBuffer, byte, len - first) != NULL;
 }
 #endif
 
-#if defined(UART_MULTIPLE_BUFFERS) && (UART_MULTIPLE_BUFFERS > 0)
-void uart_writeLine(UARTBuffer *uartBuffer, const char *str)
+#if defined(UART_BUFFER_READY) && (UART_BUFFER_READY > 0)
+/**
+ * @brief Flags UART buffer in its readiness set once data from 'start' to 'head' has been published
+ * (producer side). The task is only woken up when a bit goes from clear to set
+ */
+static void uart_readyRx(UARTBuffer *buffer, uart_index_t start, uart_index_t head)
 {
-    uart_puts(uartBuffer, str);
-    uartBuffer->writeByte('\r');
-    uartBuffer->writeByte('\n');
+    UARTReadySet *set = buffer->readySet;
+    uint32_t bit = buffer->readyBit;
+    bool raised = false;
+    if (buffer->readyDelimiter != UART_READY_NO_DELIMITER && uart_rxReceived(buffer, start, head, buffer->readyDelimiter))
+        raised = (UART_MASK_OR(set->delimiter, bit) & bit) == 0;
+    // Always a read-modify-write (no plain load shortcut), so it's ordered against uart_waitAny clearing the bit
+    if (uart_rxUsed(buffer) >= buffer->rxThreshold)
+        raised |= (UART_MASK_OR(set->rx, bit) & bit) == 0;
+    if (raised && set->wake != NULL)
+        set->wake(set->context);
 }
-#else
-void uart_writeLine(const char *str)
+#endif
+
+#if defined(UART_BUFFER_EVENTS) && (UART_BUFFER_EVENTS > 0)
+/**
+ * @brief Reports events from a handler: straight to the callback, or accumulated for uart_dispatchRxEvents
+ * (defer is only called when nothing was pending, so one dispatch serves a whole burst)
+ */
+static void uart_rxEventRaise(UARTBuffer *buffer, uint8_t events)
+{
+    if (buffer->rxEventDefer == NULL)
+        buffer->rxEvent(buffer->rxEventContext, events);
+    else if (UART_MASK_OR(buffer->rxEventPending, events) == 0)
+        buffer->rxEventDefer(buffer->rxEventContext);
+}
+
+/**
+ * @brief Checks threshold and delimiter events once data from 'start' to 'head' has been published
+ * (producer side). The threshold fires when the fill level goes from below it to at least it
+ */
+static void uart_rxEvents(UARTBuffer *buffer, uart_index_t start, uart_index_t head)
 {
-    uart_puts(str);
-    uartBuffer.writeByte('\r');
-    uartBuffer.writeByte('\n');
+    uint8_t events = 0;
+    if (buffer->rxEventThreshold != 0)
+    {
+        uart_index_t tail = UART_LOAD_ACQUIRE(buffer->rxTail);
+        size_t before = (uart_index_t)(start - tail);
+        size_t after = (uart_index_t)(head - tail);
+        if (before < buffer->rxEventThreshold && after >= buffer->rxEventThreshold)
+            events |= UART_RX_EVENT_THRESHOLD;
+    }
+    if (buffer->rxEventDelimiter != UART_RX_EVENT_NO_DELIMITER && uart_rxReceived(buffer, start, head, buffer->rxEventDelimiter))
+        events |= UART_RX_EVENT_DELIMITER;
+    if (events != 0)
+        uart_rxEventRaise(buffer, events);
 }
 #endif
 
-#if defined(UART_MULTIPLE_BUFFERS) && (UART_MULTIPLE_BUFFERS > 0)
-void uart_writeBuffer(UARTBuffer *uartBuffer, uint8_t *buffer, size_t len)
+#if defined(UART_BUFFER_TIMESTAMP) && (UART_BUFFER_TIMESTAMP > 0)
+/**
+ * @brief Stamps 'len' bytes written from 'head' with the current time, before they are published (producer side)
+ */
+static void uart_rxStamp(UARTBuffer *buffer, uart_index_t head, size_t len)
 {
+    uint32_t now = buffer->rxStampNow();
     for (size_t i = 0; i != len; i++)
     {
-        uartBuffer->writeByte(*buffer++);
+        buffer->rxStamps[(uart_index_t)(head + i) & buffer->rxMask] = now;
     }
 }
-#else
-void uart_writeBuffer(uint8_t *buffer, size_t len)
+#endif
+
+/**
+ * @brief Publishes received data (producer side) and wakes up a reader waiting for it
+ */
+static inline void uart_rxPublish(UARTBuffer *buffer, uart_index_t head)
 {
-    for (size_t i = 0; i != len; i++)
+#if (defined(UART_BUFFER_READY) && (UART_BUFFER_READY > 0)) || (defined(UART_BUFFER_EVENTS) && (UART_BUFFER_EVENTS > 0)) || \
+    (defined(UART_BUFFER_LOG) && (UART_BUFFER_LOG > 0))
+    uart_index_t start = buffer->rxHead;
+#endif
+    UART_STORE_RELEASE(buffer->rxHead, head);
+    UART_TRACE(buffer, UART_TRACE_RX, (uart_index_t)(head - start));
+#if defined(UART_BUFFER_READY) && (UART_BUFFER_READY > 0)
+    if (buffer->readySet != NULL)
+        uart_readyRx(buffer, start, head);
+#endif
+#if defined(UART_BUFFER_EVENTS) && (UART_BUFFER_EVENTS > 0)
+    if (buffer->rxEvent != NULL)
+        uart_rxEvents(buffer, start, head);
+#endif
+    if (buffer->rxWake != NULL)
+        buffer->rxWake(buffer->waitContext);
+}
+
+/**
+ * @brief Stores a received byte according to the overflow policy (producer side)
+ */
+static inline void uart_rxPush(UARTBuffer *buffer, uint8_t data)
+{
+    uart_index_t head = buffer->rxHead;   // Only written from the producer context
+    UART_STATS_ADD(buffer, rxInterrupts, 1);
+    UART_STATS_ADD(buffer, rxBytes, 1);
+    UART_CAPTURE(buffer, &data, 1);
+    if (buffer->overflowPolicy != UART_OVERFLOW_OVERWRITE)
     {
-        uartBuffer.writeByte(*buffer++);
+        uart_index_t used = (uart_index_t)(head - UART_LOAD_ACQUIRE(buffer->rxTail));
+        if (used >= buffer->rxSize)
+        {
+            UART_STATS_ADD(buffer, rxDropped, 1);
+            UART_TRACE(buffer, UART_TRACE_DROP, 1);
+            return;   // Newest byte is dropped
+        }
+        uart_rxCheckHighWatermark(buffer, (size_t)used + 1);
     }
+    uart_rxClaim(buffer, (uart_index_t)(head + 1));
+    buffer->rxBuffer[head & buffer->rxMask] = data;
+    UART_RX_STAMP(buffer, head, 1);
+    uart_rxPublish(buffer, (uart_index_t)(head + 1));
+    UART_STATS_PEAK(buffer, uart_rxUsed(buffer));
+}
+
+/**
+ * @brief Copies up to 'len' available bytes with at most two memcpy calls (before and after the
+ * wrap-around point) and releases them with a single rxTail update
+ * @param buffer Reference to UART buffer
+ * @param data Reference to store read bytes
+ * @param len Max byte quantity to read
+ * @return size_t Byte quantity actually read
+ */
+static size_t uart_rxDequeue(UARTBuffer *buffer, uint8_t *data, size_t len)
+{
+    uart_index_t tail;
+    size_t count = uart_rxSync(buffer, &tail);
+    if (count > len)
+        count = len;
+    if (count == 0)
+        return 0;
+
+    size_t offset = tail & buffer->rxMask;
+    size_t first = buffer->rxSize - offset;
+    if (first > count)
+        first = count;
+    memcpy(data, &buffer->rxBuffer[offset], first);
+    memcpy(data + first, buffer->rxBuffer, count - first);
+    uart_rxSetTail(buffer, (uart_index_t)(tail + count));
+    count = uart_rxDropLapped(buffer, data, tail, count);
+    UART_TRACE(buffer, UART_TRACE_READ, count);
+    UART_CRC_UPDATE(buffer->rxCrc, data, count);
+    return count;
+}
+
+/**
+ * @brief Splits 'len' ring bytes starting at free-running index 'start' into up to two contiguous spans
+ */
+static inline size_t uart_rxSpans(UARTBuffer *buffer, UARTSpan spans[2], uart_index_t start, size_t len)
+{
+    size_t offset = start & buffer->rxMask;
+    size_t first = buffer->rxSize - offset;
+    if (first > len)
+        first = len;
+    spans[0].data = &buffer->rxBuffer[offset];
+    spans[0].len = first;
+    spans[1].data = buffer->rxBuffer;
+    spans[1].len = len - first;
+    return len;
 }
+
+/**
+ * @brief Readable ring data as up to two spans (consumer side)
+ */
+static inline size_t uart_rxPeek(UARTBuffer *buffer, UARTSpan spans[2])
+{
+    uart_index_t tail;
+    size_t used = uart_rxSync(buffer, &tail);
+    return uart_rxSpans(buffer, spans, tail, used);
+}
+
+/**
+ * @brief Releases up to 'len' bytes from the RX ring (consumer side)
+ */
+static inline void uart_rxRelease(UARTBuffer *buffer, size_t len)
+{
+    uart_index_t tail;
+    size_t used = uart_rxSync(buffer, &tail);
+    if (len > used)
+        len = used;
+    uart_rxSetTail(buffer, (uart_index_t)(tail + len));
+    UART_TRACE(buffer, UART_TRACE_READ, len);
+}
+
+/**
+ * @brief Free space in the RX ring and current write index (producer side)
+ */
+static inline size_t uart_rxFree(UARTBuffer *buffer, uart_index_t *head)
+{
+    uart_index_t used = (uart_index_t)(buffer->rxHead - UART_LOAD_ACQUIRE(buffer->rxTail));
+    *head = buffer->rxHead;
+    return (used >= buffer->rxSize) ? 0 : (size_t)(buffer->rxSize - used);
+}
+
+/**
+ * @brief Waits until RX data is available or the deadline expires. Sleeps through the rxWait hook if
+ * registered, otherwise spins. Without a time source only UART_WAIT_FOREVER waits
+ * @param buffer Reference to UART buffer
+ * @param start Time when the operation started (timeNow units)
+ * @param timeout Timeout in microseconds, or UART_WAIT_FOREVER
+ * @return true Data is available
+ * @return false Timeout expired
+ */
+static bool uart_rxWaitData(UARTBuffer *buffer, uint32_t start, uint32_t timeout)
+{
+    bool ready = true;
+    if (uart_rxUsed(buffer) != 0)
+        return true;
+#if defined(UART_BUFFER_STATS) && (UART_BUFFER_STATS > 0)
+    uint32_t begin = (buffer->timeNow != NULL) ? buffer->timeNow() : 0;
 #endif
+    while (uart_rxUsed(buffer) == 0)
+    {
+        uint32_t left = UART_WAIT_FOREVER;
+        if (timeout != UART_WAIT_FOREVER)
+        {
+            uint32_t elapsed = (buffer->timeNow != NULL) ? buffer->timeNow() - start : timeout;
+            if (elapsed >= timeout)
+            {
+                ready = false;
+                break;
+            }
+            left = timeout - elapsed;
+        }
+        if (buffer->rxWait != NULL)
+            buffer->rxWait(buffer->waitContext, left);
+    }
+#if defined(UART_BUFFER_STATS) && (UART_BUFFER_STATS > 0)
+    buffer->stats.waits++;
+    if (buffer->timeNow != NULL)
+        buffer->stats.waitTime += buffer->timeNow() - begin;
+#endif
+    return ready;
+}
 
-#if defined(UART_MULTIPLE_BUFFERS) && (UART_MULTIPLE_BUFFERS > 0)
-void uart_write(UARTBuffer *uartBuffer, void *data, size_t len)
+/**
+ * @brief Reads 'len' bytes in bulk, waiting for data up to 'timeout' microseconds in total
+ * @return size_t Byte quantity actually read
+ */
+static size_t uart_rxReadTimeout(UARTBuffer *buffer, uint8_t *data, size_t len, uint32_t timeout)
 {
-    uint8_t *_data = (uint8_t *)data;
-    while (len--)
+    uint32_t start = (buffer->timeNow != NULL) ? buffer->timeNow() : 0;
+    size_t done = uart_rxDequeue(buffer, data, len);
+    while (done != len && uart_rxWaitData(buffer, start, timeout))
     {
-        uartBuffer->writeByte(*_data++);
+        done += uart_rxDequeue(buffer, data + done, len - done);
     }
+    return done;
 }
-#else
-void uart_write(void *data, size_t len)
+
+/**
+ * @brief Searches the delimiter in up to 'len' bytes of two spans, skipping the first 'from' bytes
+ * @return size_t Bytes up to and including the delimiter, or 0 if not found
+ */
+static size_t uart_spanFind(const UARTSpan spans[2], size_t from, size_t len, uint8_t delimiter)
 {
-    uint8_t *_data = (uint8_t *)data;
-    while (len--)
+    size_t offset = 0;
+    for (size_t s = 0; s != 2 && offset < len; s++)
     {
-        uartBuffer.writeByte(*_data++);
+        size_t spanLen = (spans[s].len > len - offset) ? len - offset : spans[s].len;
+        if (from < spanLen)
+        {
+            const uint8_t *found = (const uint8_t *)memchr(spans[s].data + from, delimiter, spanLen - from);
+            if (found != NULL)
+                return offset + (size_t)(found - spans[s].data) + 1;
+            from = 0;
+        }
+        else
+        {
+            from -= spanLen;
+        }
+        offset += spanLen;
     }
+    return 0;
 }
-#endif
 
-#if defined(UART_MULTIPLE_BUFFERS) && (UART_MULTIPLE_BUFFERS > 0)
-void uart_read(UARTBuffer *uartBuffer, void *data, size_t len)
+/**
+ * @brief Non-blocking line assembly: moves data up to the delimiter (or up to the free line storage) from
+ * the ring into reader->line with bulk copies
+ */
+static char *uart_rxGetLine(UARTBuffer *buffer, UARTLineReader *reader)
 {
-    uint8_t *_data = (uint8_t *)data;
-    while (len--)
+    UARTSpan spans[2];
+    uart_index_t tail;
+    if (reader->size < 1)
+        return NULL;    // No room even for the NUL terminator
+    size_t room = reader->size - 1 - reader->len;
+    size_t available = uart_rxSync(buffer, &tail);
+    if (available > room)
+        available = room;
+    uart_rxSpans(buffer, spans, tail, available);
+
+    size_t count = uart_spanFind(spans, 0, available, reader->delimiter);
+    bool complete = (count != 0);
+    if (!complete)
+        count = available;
+
+    size_t first = (count > spans[0].len) ? spans[0].len : count;
+    memcpy(reader->line + reader->len, spans[0].data, first);
+    memcpy(reader->line + reader->len + first, spans[1].data, count - first);
+    uart_rxSetTail(buffer, (uart_index_t)(tail + count));
+    size_t valid = uart_rxDropLapped(buffer, (uint8_t *)reader->line + reader->len, tail, count);
+    if (valid == 0)
+        complete = false;   // Delimiter was overwritten too
+    count = valid;
+    UART_TRACE(buffer, UART_TRACE_READ, count);
+    UART_CRC_UPDATE(buffer->rxCrc, reader->line + reader->len, count);
+    reader->len += count;
+
+    if (!complete && reader->len != reader->size - 1)
+        return NULL;
+    reader->line[reader->len] = '\0';
+    reader->truncated = !complete;
+    reader->len = 0;
+    return reader->line;
+}
+
+/**
+ * @brief Line assembly waiting for data up to 'timeout' microseconds in total. Partial line is kept in reader on timeout
+ */
+static char *uart_rxGetLineTimeout(UARTBuffer *buffer, UARTLineReader *reader, uint32_t timeout)
+{
+    uint32_t start = (buffer->timeNow != NULL) ? buffer->timeNow() : 0;
+    char *line;
+    while ((line = uart_rxGetLine(buffer, reader)) == NULL)
     {
-        while(uart_dataAvailable(uartBuffer)==0);
-        uart_readByteBuffer(uartBuffer, _data++);
+        if (!uart_rxWaitData(buffer, start, timeout))
+            break;
     }
+    return line;
 }
-#else
-void uart_read(void *data, size_t len)
+
+/**
+ * @brief Zero-copy line search. Only bytes received since the previous unsuccessful call are searched
+ */
+static size_t uart_rxPeekLine(UARTBuffer *buffer, UARTLineReader *reader, UARTSpan spans[2])
 {
-    uint8_t *_data = (uint8_t *)data;
-    while (len--)
+    size_t available = uart_rxPeek(buffer, spans);
+    if (reader->scanned > available)
+        reader->scanned = 0;    // UART buffer was consumed or flushed meanwhile
+    size_t count = uart_spanFind(spans, reader->scanned, available, reader->delimiter);
+    if (count == 0)
     {
-        while(uart_dataAvailable()==0);
-        uart_readByteBuffer( _data++);
+        reader->scanned = available;
+        return 0;
     }
+    reader->scanned = 0;    // Caller is expected to consume this line
+    if (spans[0].len > count)
+        spans[0].len = count;
+    spans[1].len = count - spans[0].len;
+    return count;
+}
+
+/**
+ * @brief Reads up to 'len' bytes (not more than the ring size) from the hardware FIFO into the ring at
+ * free-running index 'head': first up to the wrap-around point, then (if the FIFO still had data) from the
+ * start of rxBuffer
+ */
+static size_t uart_rxBurstRead(UARTBuffer *buffer, uart_index_t head, size_t len)
+{
+    size_t offset = head & buffer->rxMask;
+    size_t first = buffer->rxSize - offset;
+    if (first > len)
+        first = len;
+    size_t count = (first != 0) ? buffer->readBytes(&buffer->rxBuffer[offset], first) : 0;
+    UART_CAPTURE(buffer, &buffer->rxBuffer[offset], count);
+    if (count == first && count < len)
+    {
+        size_t wrapped = buffer->readBytes(buffer->rxBuffer, len - count);
+        UART_CAPTURE(buffer, buffer->rxBuffer, wrapped);
+        count += wrapped;
+    }
+    return count;
 }
-#endif
 
-#if defined(UART_MULTIPLE_BUFFERS) && (UART_MULTIPLE_BUFFERS > 0)
-void uart_interruptHandler(UARTBuffer *uartBuffer)
+/**
+ * @brief Reads a burst from the hardware FIFO into the free space of the ring. If the FIFO still has data,
+ * under overwrite policy it keeps reading over the oldest bytes (up to a whole ring), one byte at a time so
+ * that rxClaim tells readers exactly which ones were overwritten; with drop-newest policy the rest of the
+ * FIFO is discarded, and with backpressure it's left in the hardware FIFO
+ */
+static size_t uart_rxBurst(UARTBuffer *buffer)
 {
-    uint8_t data = uartBuffer->readByte();
-    if (((uartBuffer->queueEnd == UART_RX_BUFFER_SIZE - 1) && uartBuffer->queueFront == 0) || ((uartBuffer->queueEnd + 1) == uartBuffer->queueFront))
+    uart_index_t head;
+    size_t limit = uart_rxFree(buffer, &head);
+    size_t count = uart_rxBurstRead(buffer, head, limit);
+    if (buffer->overflowPolicy == UART_OVERFLOW_OVERWRITE && count == limit)
     {
-        uartBuffer->queueFront++;
-        if (uartBuffer->queueFront == UART_RX_BUFFER_SIZE)
-            uartBuffer->queueFront = 0;
+        for (; count != buffer->rxSize; count++)
+        {
+            uart_rxClaim(buffer, (uart_index_t)(head + count + 1));
+            if (uart_rxBurstRead(buffer, (uart_index_t)(head + count), 1) == 0)
+                break;
+        }
     }
+    uart_rxClaim(buffer, (uart_index_t)(head + count));
+    if (count != 0)
+    {
+        UART_RX_STAMP(buffer, head, count);
+        uart_rxPublish(buffer, (uart_index_t)(head + count));
+    }
+    UART_STATS_ADD(buffer, rxInterrupts, 1);
+    UART_STATS_ADD(buffer, rxBytes, count);
+    UART_STATS_PEAK(buffer, uart_rxUsed(buffer));
+
+    if (buffer->overflowPolicy == UART_OVERFLOW_DROP_NEWEST && count == limit)
+    {
+        uint8_t discard[16];
+        size_t dropped;
+        while ((dropped = buffer->readBytes(discard, sizeof(discard))) != 0)
+        {
+            UART_CAPTURE(buffer, discard, dropped);
+            UART_STATS_ADD(buffer, rxBytes, dropped);
+            UART_STATS_ADD(buffer, rxDropped, dropped);
+            UART_TRACE(buffer, UART_TRACE_DROP, dropped);
+        }
+    }
+    uart_rxCheckHighWatermark(buffer, buffer->rxSize - limit + count);
+    return count;
+}
+
+/**
+ * @brief Bytes queued in TX ring and not sent yet
+ */
+static inline size_t uart_txUsed(UARTBuffer *buffer)
+{
+    return (uart_index_t)(UART_LOAD_ACQUIRE(buffer->txHead) - UART_LOAD_ACQUIRE(buffer->txTail));
+}
 
-    if (uartBuffer->queueEnd == UART_RX_BUFFER_SIZE - 1)
-        uartBuffer->queueEnd = 0;
-    else
-        uartBuffer->queueEnd++;
-    uartBuffer->rxBuffer[uartBuffer->queueEnd] = data;
-    
-    if (uartBuffer->queueFront == -1)
-        uartBuffer->queueFront = 0;
+/**
+ * @brief Queued TX data as up to two spans (drain side)
+ */
+static inline size_t uart_txSpans(UARTBuffer *buffer, UARTSpan spans[2])
+{
+    uart_index_t tail = buffer->txTail;   // Only written from drain side
+    size_t len = (uart_index_t)(UART_LOAD_ACQUIRE(buffer->txHead) - tail);
+    size_t offset = tail & buffer->txMask;
+    size_t first = buffer->txSize - offset;
+    if (first > len)
+        first = len;
+    spans[0].data = &buffer->txBuffer[offset];
+    spans[0].len = first;
+    spans[1].data = buffer->txBuffer;
+    spans[1].len = len - first;
+    return len;
 }
+
+#if defined(UART_BUFFER_READY) && (UART_BUFFER_READY > 0)
+/**
+ * @brief Flags UART buffer in its readiness set once TX ring space reaches txThreshold (TX drain side)
+ */
+static void uart_readyTx(UARTBuffer *buffer)
+{
+    UARTReadySet *set = buffer->readySet;
+    uint32_t bit = buffer->readyBit;
+    if (buffer->txThreshold == 0)
+        return;
+    if (buffer->txSize - uart_txUsed(buffer) >= buffer->txThreshold && (UART_MASK_OR(set->tx, bit) & bit) == 0 && set->wake != NULL)
+        set->wake(set->context);
+}
+#define UART_READY_TX(buffer) do { if ((buffer)->readySet != NULL) uart_readyTx(buffer); } while (0)
 #else
-void uart_interruptHandler()
+#define UART_READY_TX(buffer) ((void)0)
+#endif
+
+/**
+ * @brief Releases up to 'len' sent bytes from the TX ring (drain side)
+ */
+static inline void uart_txRelease(UARTBuffer *buffer, size_t len)
+{
+    uart_index_t tail = buffer->txTail;
+    size_t used = (uart_index_t)(UART_LOAD_ACQUIRE(buffer->txHead) - tail);
+    if (len > used)
+        len = used;
+    UART_STORE_RELEASE(buffer->txTail, (uart_index_t)(tail + len));
+    UART_READY_TX(buffer);
+}
+
+/**
+ * @brief Copies up to 'len' bytes into the TX ring with at most two memcpy calls, publishes them with a
+ * single txHead update and enables the TX-empty interrupt
+ * @param buffer Reference to UART buffer
+ * @param data Reference to data to be queued
+ * @param len Max byte quantity to queue
+ * @return size_t Byte quantity actually queued
+ */
+static size_t uart_txEnqueue(UARTBuffer *buffer, const uint8_t *data, size_t len)
+{
+    uart_index_t head = buffer->txHead;
+    size_t space = buffer->txSize - (uart_index_t)(head - UART_LOAD_ACQUIRE(buffer->txTail));
+    if (len > space)
+        len = space;
+    if (len == 0)
+        return 0;
+
+    size_t offset = head & buffer->txMask;
+    size_t first = buffer->txSize - offset;
+    if (first > len)
+        first = len;
+    memcpy(&buffer->txBuffer[offset], data, first);
+    memcpy(buffer->txBuffer, data + first, len - first);
+    UART_CRC_UPDATE(buffer->txCrc, data, len);
+    UART_STATS_ADD(buffer, txBytes, len);
+    UART_TRACE(buffer, UART_TRACE_TX, len);
+    UART_STORE_RELEASE(buffer->txHead, (uart_index_t)(head + len));
+    buffer->txInterruptEnable(true);
+    return len;
+}
+
+/**
+ * @brief Sends 'len' bytes, through the TX ring if it's enabled (waiting only while it's full) or
+ * synchronously through writeByte otherwise
+ */
+static void uart_txWrite(UARTBuffer *buffer, const uint8_t *data, size_t len)
 {
-    uint8_t data = uartBuffer.readByte();
-    if (((uartBuffer.queueEnd == UART_RX_BUFFER_SIZE - 1) && uartBuffer.queueFront == 0) || ((uartBuffer.queueEnd + 1) == uartBuffer.queueFront))
+    if (buffer->txInterruptEnable == NULL)
     {
-        uartBuffer.queueFront++;
-        if (uartBuffer.queueFront == UART_RX_BUFFER_SIZE)
-            uartBuffer.queueFront = 0;
+        UART_CRC_UPDATE(buffer->txCrc, data, len);
+        UART_STATS_ADD(buffer, txBytes, len);
+        UART_TRACE(buffer, UART_TRACE_TX, len);
+        while (len--)
+        {
+            buffer->writeByte(*data++);
+        }
+        return;
     }
+    while (len)
+    {
+        size_t count = uart_txEnqueue(buffer, data, len);
+        data += count;
+        len -= count;
+    }
+}
 
-    if (uartBuffer.queueEnd == UART_RX_BUFFER_SIZE - 1)
-        uartBuffer.queueEnd = 0;
-    else
-        uartBuffer.queueEnd++;
-    uartBuffer.rxBuffer[uartBuffer.queueEnd] = data;
-    
-    if (uartBuffer.queueFront == -1)
-        uartBuffer.queueFront = 0;
+/**
+ * @brief Common initialization: validates storage sizes and resets indexes and callbacks
+ */
+static bool uart_bufferSetup(UARTBuffer *buffer, uint8_t *rxStorage, size_t rxSize, uint8_t *txStorage, size_t txSize, void (*writeByte_callback)(uint8_t), uint8_t (*readByte_callback)(void))
+{
+    if (rxSize < 2 || rxSize > UART_MAX_CAPACITY || (rxSize & (rxSize - 1)) != 0)
+        return false;
+    if (txSize < 2 || txSize > UART_MAX_CAPACITY || (txSize & (txSize - 1)) != 0)
+        return false;
+    memset(rxStorage, 0, rxSize);
+    buffer->rxBuffer = rxStorage;
+    buffer->rxSize = (uart_index_t)rxSize;
+    buffer->rxMask = (uart_index_t)(rxSize - 1);
+    buffer->rxHead = 0;
+    buffer->rxTail = 0;
+    buffer->rxClaim = 0;
+    buffer->txBuffer = txStorage;
+    buffer->txSize = (uart_index_t)txSize;
+    buffer->txMask = (uart_index_t)(txSize - 1);
+    buffer->txHead = 0;
+    buffer->txTail = 0;
+    buffer->baudRate = 0;
+    buffer->writeByte = writeByte_callback;
+    buffer->readByte = readByte_callback;
+    buffer->readBytes = NULL;
+    buffer->txInterruptEnable = NULL;
+    buffer->overflowPolicy = UART_OVERFLOW_OVERWRITE;
+    buffer->highWatermark = rxSize;
+    buffer->lowWatermark = 0;
+    buffer->flowStopped = false;
+    buffer->flowControl = NULL;
+#if defined(UART_BUFFER_CRC) && (UART_BUFFER_CRC > 0)
+    buffer->rxCrc = NULL;
+    buffer->txCrc = NULL;
+#endif
+    buffer->timeNow = NULL;
+    buffer->rxWait = NULL;
+    buffer->rxWake = NULL;
+    buffer->waitContext = NULL;
+#if defined(UART_BUFFER_CAPTURE) && (UART_BUFFER_CAPTURE > 0)
+    buffer->capture = NULL;
+#endif
+#if defined(UART_BUFFER_READY) && (UART_BUFFER_READY > 0)
+    buffer->readySet = NULL;
+#endif
+#if defined(UART_BUFFER_EVENTS) && (UART_BUFFER_EVENTS > 0)
+    buffer->rxEvent = NULL;
+    buffer->rxEventDefer = NULL;
+    buffer->rxEventContext = NULL;
+    buffer->rxEventThreshold = 0;
+    buffer->rxEventDelimiter = UART_RX_EVENT_NO_DELIMITER;
+    buffer->rxIdleHead = 0;
+    UART_MASK_EXCHANGE(buffer->rxEventPending, 0);
+#endif
+#if defined(UART_BUFFER_TIMESTAMP) && (UART_BUFFER_TIMESTAMP > 0)
+    buffer->rxStamps = NULL;
+    buffer->rxStampNow = NULL;
+#endif
+#if defined(UART_BUFFER_STATS) && (UART_BUFFER_STATS > 0)
+    memset(&buffer->stats, 0, sizeof(buffer->stats));
+#endif
+    return true;
+}
+
+#if defined(UART_BUFFER_STATIC_STORAGE) && (UART_BUFFER_STATIC_STORAGE > 0)
+// Compile-time check: embedded storage must fit uart_index_t
+typedef char uart_staticStorageCheck[((UART_RX_BUFFER_SIZE <= UART_MAX_CAPACITY) && (UART_TX_BUFFER_SIZE <= UART_MAX_CAPACITY)) ? 1 : -1];
+
+void uart_buffer_init(UART_BUFFER_PARAM void (*writeByte_callback)(uint8_t), uint8_t (*readByte_callback)(void))
+{
+    uart_bufferSetup(UART_BUFFER_SELF, UART_BUFFER_SELF->rxStorage, UART_RX_BUFFER_SIZE, UART_BUFFER_SELF->txStorage, UART_TX_BUFFER_SIZE, writeByte_callback, readByte_callback);
 }
 #endif
 
-#if defined(UART_MULTIPLE_BUFFERS) && (UART_MULTIPLE_BUFFERS > 0)
-size_t uart_dataAvailable(UARTBuffer *uartBuffer)
+bool uart_buffer_initStorage(UART_BUFFER_PARAM uint8_t *rxStorage, size_t rxSize, uint8_t *txStorage, size_t txSize, void (*writeByte_callback)(uint8_t), uint8_t (*readByte_callback)(void))
 {
-    if(uartBuffer->queueFront==-1) 
-        return 0;
-    else if(uartBuffer->queueFront<uartBuffer->queueEnd)
-        return (uartBuffer->queueEnd-uartBuffer->queueFront+1);
-    else if(uartBuffer->queueFront>uartBuffer->queueEnd)
-        return(UART_RX_BUFFER_SIZE-uartBuffer->queueFront+uartBuffer->queueEnd+1);
-    else
-        return 1;
+    return uart_bufferSetup(UART_BUFFER_SELF, rxStorage, rxSize, txStorage, txSize, writeByte_callback, readByte_callback);
 }
-#else
-size_t uart_dataAvailable()
+
+void uart_rxBurstInit(UART_BUFFER_PARAM size_t (*readBytes_callback)(uint8_t *data, size_t max))
 {
-    if(uartBuffer.queueFront==-1) 
-        return 0;
-    else if(uartBuffer.queueFront<uartBuffer.queueEnd)
-        return (size_t)(uartBuffer.queueEnd-uartBuffer.queueFront+1);
-    else if(uartBuffer.queueFront>uartBuffer.queueEnd)
-        return (size_t)(UART_RX_BUFFER_SIZE-uartBuffer.queueFront+uartBuffer.queueEnd+1);
-    else
-        return 1;
+    UART_BUFFER_SELF->readBytes = readBytes_callback;
+}
+
+void uart_setOverflowPolicy(UART_BUFFER_PARAM UART_OverflowPolicy policy, size_t highWatermark, size_t lowWatermark, void (*flowControl_callback)(bool))
+{
+    UART_BUFFER_SELF->highWatermark = highWatermark;
+    UART_BUFFER_SELF->lowWatermark = lowWatermark;
+    UART_BUFFER_SELF->flowStopped = false;
+    UART_BUFFER_SELF->flowControl = flowControl_callback;
+    UART_BUFFER_SELF->rxClaim = UART_BUFFER_SELF->rxHead;
+    UART_BUFFER_SELF->overflowPolicy = (policy == UART_OVERFLOW_BACKPRESSURE && flowControl_callback == NULL) ? UART_OVERFLOW_DROP_NEWEST : policy;
+}
+
+#if defined(UART_BUFFER_CRC) && (UART_BUFFER_CRC > 0)
+void uart_setCrc(UART_BUFFER_PARAM UARTCrc *rxCrc, UARTCrc *txCrc)
+{
+    UART_BUFFER_SELF->rxCrc = rxCrc;
+    UART_BUFFER_SELF->txCrc = txCrc;
 }
 #endif
 
-#if defined(UART_MULTIPLE_BUFFERS) && (UART_MULTIPLE_BUFFERS > 0)
-void uart_readByteBuffer(UARTBuffer *uartBuffer, uint8_t *byte)
+void uart_setWaitHooks(UART_BUFFER_PARAM uint32_t (*timeNow_callback)(void), void (*rxWait_callback)(void *context, uint32_t timeout), void (*rxWake_callback)(void *context), void *context)
 {
-    // Verify if queue is empty
-    if (uartBuffer->queueFront == -1)
-        return;
+    UART_BUFFER_SELF->timeNow = timeNow_callback;
+    UART_BUFFER_SELF->waitContext = context;
+    UART_BUFFER_SELF->rxWait = rxWait_callback;
+    UART_BUFFER_SELF->rxWake = rxWake_callback;
+}
 
-    *byte = uartBuffer->rxBuffer[uartBuffer->queueFront];
+void uart_txInit(UART_BUFFER_PARAM void (*txInterruptEnable_callback)(bool), uint32_t baudRate)
+{
+    UART_BUFFER_SELF->txHead = 0;
+    UART_BUFFER_SELF->txTail = 0;
+    UART_BUFFER_SELF->baudRate = baudRate;
+    UART_BUFFER_SELF->txInterruptEnable = txInterruptEnable_callback;
+}
 
-    if (uartBuffer->queueFront == uartBuffer->queueEnd)
-    {
-        // If it's only one byte, queue is now empty
-        uartBuffer->queueFront = -1;
-        uartBuffer->queueEnd = -1;
-    }
-    else
+void uart_puts(UART_BUFFER_PARAM const char *str)
+{
+    uart_txWrite(UART_BUFFER_SELF, (const uint8_t *)str, strlen(str));
+}
+
+char *uart_gets(UART_BUFFER_PARAM char *buffer, size_t len)
+{
+    UARTLineReader reader;
+    char *line;
+    if (len < 1)
+        return NULL;
+    uart_lineReaderInit(&reader, buffer, len, UART_LINE_DELIMITER);
+    line = uart_rxGetLineTimeout(UART_BUFFER_SELF, &reader, UART_WAIT_FOREVER);
+    return reader.truncated ? NULL : line;
+}
+
+void uart_lineReaderInit(UARTLineReader *reader, char *buffer, size_t size, uint8_t delimiter)
+{
+    reader->line = buffer;
+    reader->size = size;
+    reader->len = 0;
+    reader->scanned = 0;
+    reader->delimiter = delimiter;
+    reader->truncated = false;
+}
+
+char *uart_getLine(UART_BUFFER_PARAM UARTLineReader *reader)
+{
+    return uart_rxGetLine(UART_BUFFER_SELF, reader);
+}
+
+char *uart_getLineTimeout(UART_BUFFER_PARAM UARTLineReader *reader, uint32_t timeout)
+{
+    return uart_rxGetLineTimeout(UART_BUFFER_SELF, reader, timeout);
+}
+
+char *uart_getsTimeout(UART_BUFFER_PARAM char *buffer, size_t len, uint32_t timeout)
+{
+    UARTLineReader reader;
+    char *line;
+    if (len < 1)
+        return NULL;
+    uart_lineReaderInit(&reader, buffer, len, UART_LINE_DELIMITER);
+    line = uart_rxGetLineTimeout(UART_BUFFER_SELF, &reader, timeout);
+    return (line == NULL || reader.truncated) ? NULL : line;
+}
+
+size_t uart_peekLine(UART_BUFFER_PARAM UARTLineReader *reader, UARTSpan spans[2])
+{
+    return uart_rxPeekLine(UART_BUFFER_SELF, reader, spans);
+}
+
+void uart_writeLine(UART_BUFFER_PARAM const char *str)
+{
+    uart_puts(UART_BUFFER_ARG(uartBuffer) str);
+    uart_txWrite(UART_BUFFER_SELF, (const uint8_t *)"\r\n", 2);
+}
+
+void uart_writeBuffer(UART_BUFFER_PARAM uint8_t *buffer, size_t len)
+{
+    uart_txWrite(UART_BUFFER_SELF, buffer, len);
+}
+
+void uart_write(UART_BUFFER_PARAM void *data, size_t len)
+{
+    uart_txWrite(UART_BUFFER_SELF, (const uint8_t *)data, len);
+}
+
+size_t uart_writeAsync(UART_BUFFER_PARAM const void *data, size_t len)
+{
+    if (UART_BUFFER_SELF->txInterruptEnable == NULL)
     {
-        uartBuffer->queueFront++;
-        if (uartBuffer->queueFront == UART_RX_BUFFER_SIZE)
-            uartBuffer->queueFront = 0;
+        uart_txWrite(UART_BUFFER_SELF, (const uint8_t *)data, len);
+        return len;
     }
+    return uart_txEnqueue(UART_BUFFER_SELF, (const uint8_t *)data, len);
 }
-#else
-void uart_readByteBuffer(uint8_t *byte)
+
+size_t uart_txSpace(UART_BUFFER_ONLY)
+{
+    return UART_BUFFER_SELF->txSize - uart_txUsed(UART_BUFFER_SELF);
+}
+
+size_t uart_txPending(UART_BUFFER_ONLY)
+{
+    return uart_txUsed(UART_BUFFER_SELF);
+}
+
+uint32_t uart_txDrainTime(UART_BUFFER_ONLY)
+{
+    if (UART_BUFFER_SELF->baudRate == 0)
+        return 0;
+    return (uint32_t)(((uint64_t)uart_txUsed(UART_BUFFER_SELF) * UART_FRAME_BITS * 1000000UL) / UART_BUFFER_SELF->baudRate);
+}
+
+void uart_read(UART_BUFFER_PARAM void *data, size_t len)
+{
+    uart_readBuffer(UART_BUFFER_ARG(uartBuffer) (uint8_t *)data, len);
+}
+
+size_t uart_readTimeout(UART_BUFFER_PARAM void *data, size_t len, uint32_t timeout)
+{
+    return uart_rxReadTimeout(UART_BUFFER_SELF, (uint8_t *)data, len, timeout);
+}
+
+void uart_interruptHandler(UART_BUFFER_ONLY)
+{
+    uart_rxPush(UART_BUFFER_SELF, UART_BUFFER_SELF->readByte());
+}
+
+size_t uart_burstInterruptHandler(UART_BUFFER_ONLY)
+{
+    return uart_rxBurst(UART_BUFFER_SELF);
+}
+
+void uart_txInterruptHandler(UART_BUFFER_ONLY)
 {
-    // Verify if queue is empty
-    if (uartBuffer.queueFront == -1)
+    uart_index_t tail = UART_BUFFER_SELF->txTail;   // Only written from here
+    UART_STATS_ADD(UART_BUFFER_SELF, txInterrupts, 1);
+    if (UART_LOAD_ACQUIRE(UART_BUFFER_SELF->txHead) == tail)
+    {
+        UART_BUFFER_SELF->txInterruptEnable(false);
+        // Data may have been queued (and the interrupt enabled) right before disabling it
+        if (UART_LOAD_ACQUIRE(UART_BUFFER_SELF->txHead) != tail)
+            UART_BUFFER_SELF->txInterruptEnable(true);
         return;
+    }
+    UART_BUFFER_SELF->writeByte(UART_BUFFER_SELF->txBuffer[tail & UART_BUFFER_SELF->txMask]);
+    UART_STORE_RELEASE(UART_BUFFER_SELF->txTail, (uart_index_t)(tail + 1));
+    UART_READY_TX(UART_BUFFER_SELF);
+}
 
-    *byte = uartBuffer.rxBuffer[uartBuffer.queueFront];
+/**
+ * @brief Single byte read handling overruns, backpressure resume, trace and RX CRC (consumer side)
+ */
+static void uart_rxReadByte(UARTBuffer *buffer, uint8_t *byte)
+{
+    uart_index_t tail;
+    do
+    {
+        // Verify if queue is empty
+        if (uart_rxSync(buffer, &tail) == 0)
+            return;
+        *byte = buffer->rxBuffer[tail & buffer->rxMask];
+        uart_rxSetTail(buffer, (uart_index_t)(tail + 1));
+    } while (uart_rxDropLapped(buffer, byte, tail, 1) == 0);
+    UART_TRACE(buffer, UART_TRACE_READ, 1);
+    UART_CRC_UPDATE(buffer->rxCrc, byte, 1);
+}
 
-    if (uartBuffer.queueFront == uartBuffer.queueEnd)
+void uart_readByteBuffer(UART_BUFFER_PARAM uint8_t *byte)
+{
+    // Same fast path as uart_popByte: only the indexes are touched unless something else must be handled
+    uart_index_t tail = UART_BUFFER_SELF->rxTail;
+    uart_index_t used = (uart_index_t)(UART_LOAD_ACQUIRE(UART_BUFFER_SELF->rxHead) - tail);
+    if (used == 0)
+        return;
+    if ((used > UART_BUFFER_SELF->rxSize) | UART_BUFFER_SELF->flowStopped | UART_CRC_ATTACHED(UART_BUFFER_SELF) | UART_TRACE_ATTACHED(UART_BUFFER_SELF))
     {
-        // If it's only one byte, queue is now empty
-        uartBuffer.queueFront = -1;
-        uartBuffer.queueEnd = -1;
+        uart_rxReadByte(UART_BUFFER_SELF, byte);
+        return;
     }
-    else
+    *byte = UART_BUFFER_SELF->rxBuffer[tail & UART_BUFFER_SELF->rxMask];
+    if (uart_rxLapped(UART_BUFFER_SELF, tail, 1) != 0)
     {
-        uartBuffer.queueFront++;
-        if (uartBuffer.queueFront == UART_RX_BUFFER_SIZE)
-            uartBuffer.queueFront = 0;
+        uart_rxReadByte(UART_BUFFER_SELF, byte);   // Overwritten while read
+        return;
     }
+    UART_STORE_RELEASE(UART_BUFFER_SELF->rxTail, (uart_index_t)(tail + 1));
 }
-#endif
 
-#if defined(UART_MULTIPLE_BUFFERS) && (UART_MULTIPLE_BUFFERS > 0)
-UART_rxQueue_Status uart_firstByteReceived(UARTBuffer *uartBuffer, uint8_t *byte)
+#if !(defined(UART_BUFFER_INLINE) && (UART_BUFFER_INLINE > 0))
+size_t uart_dataAvailable(UART_BUFFER_ONLY)
 {
-    if(!uart_dataAvailable(uartBuffer)){
+    return uart_rxUsed(UART_BUFFER_SELF);
+}
+
+bool uart_popByte(UART_BUFFER_PARAM uint8_t *byte)
+{
+    if (uart_rxUsed(UART_BUFFER_SELF) == 0)
+        return false;
+    uart_readByteBuffer(UART_BUFFER_ARG(UART_BUFFER_SELF) byte);
+    return true;
+}
+
+UART_rxQueue_Status uart_firstByteReceived(UART_BUFFER_PARAM uint8_t *byte)
+{
+    uart_index_t tail;
+    if(uart_rxSync(UART_BUFFER_SELF, &tail) == 0){
         return UART_RX_QUEUE_EMPTY;
     }
-    *byte=uartBuffer->rxBuffer[uartBuffer->queueFront];
+    *byte=UART_BUFFER_SELF->rxBuffer[tail & UART_BUFFER_SELF->rxMask];
     return UART_RX_QUEUE_STATUS_OK;
 }
-#else
-UART_rxQueue_Status uart_firstByteReceived(uint8_t *byte)
+
+UART_rxQueue_Status uart_lastByteReceived(UART_BUFFER_PARAM uint8_t *byte)
 {
-    if(uart_dataAvailable() == 0){
+    uart_index_t head = UART_LOAD_ACQUIRE(UART_BUFFER_SELF->rxHead);
+    if(head == UART_BUFFER_SELF->rxTail){
         return UART_RX_QUEUE_EMPTY;
     }
-    *byte=uartBuffer.rxBuffer[uartBuffer.queueFront];
+    *byte=UART_BUFFER_SELF->rxBuffer[(uart_index_t)(head - 1) & UART_BUFFER_SELF->rxMask];
     return UART_RX_QUEUE_STATUS_OK;
 }
 #endif
 
-#if defined(UART_MULTIPLE_BUFFERS) && (UART_MULTIPLE_BUFFERS > 0)
-UART_rxQueue_Status uart_lastByteReceived(UARTBuffer *uartBuffer, uint8_t *byte)
+size_t uart_readAvailable(UART_BUFFER_PARAM uint8_t *buffer, size_t len)
 {
-    if(!uart_dataAvailable(uartBuffer)){
-        return UART_RX_QUEUE_EMPTY;
-    }
-    *byte=uartBuffer->rxBuffer[uartBuffer->queueEnd];
-    return UART_RX_QUEUE_STATUS_OK;
+    return uart_rxDequeue(UART_BUFFER_SELF, buffer, len);
 }
-#else
-UART_rxQueue_Status uart_lastByteReceived(uint8_t *byte)
+
+void uart_readBuffer(UART_BUFFER_PARAM uint8_t *buffer, size_t len)
 {
-    if(uart_dataAvailable() == 0){
-        return UART_RX_QUEUE_EMPTY;
-    }
-    *byte=uartBuffer.rxBuffer[uartBuffer.queueEnd];
-    return UART_RX_QUEUE_STATUS_OK;
+    uart_rxReadTimeout(UART_BUFFER_SELF, buffer, len, UART_WAIT_FOREVER);
 }
+
+size_t uart_readBufferTimeout(UART_BUFFER_PARAM uint8_t *buffer, size_t len, uint32_t timeout)
+{
+    return uart_rxReadTimeout(UART_BUFFER_SELF, buffer, len, timeout);
+}
+
+size_t uart_peek(UART_BUFFER_PARAM UARTSpan spans[2])
+{
+    return uart_rxPeek(UART_BUFFER_SELF, spans);
+}
+
+void uart_consume(UART_BUFFER_PARAM size_t len)
+{
+    uart_rxRelease(UART_BUFFER_SELF, len);
+}
+
+size_t uart_rxReserve(UART_BUFFER_PARAM UARTSpan spans[2])
+{
+    uart_index_t head;
+    size_t space = uart_rxFree(UART_BUFFER_SELF, &head);
+    return uart_rxSpans(UART_BUFFER_SELF, spans, head, space);
+}
+
+void uart_rxCommit(UART_BUFFER_PARAM size_t len)
+{
+#if defined(UART_BUFFER_CAPTURE) && (UART_BUFFER_CAPTURE > 0)
+    UARTSpan spans[2];
+    uart_rxSpans(UART_BUFFER_SELF, spans, UART_BUFFER_SELF->rxHead, len);
+    UART_CAPTURE(UART_BUFFER_SELF, spans[0].data, spans[0].len);
+    UART_CAPTURE(UART_BUFFER_SELF, spans[1].data, spans[1].len);
 #endif
+    UART_RX_STAMP(UART_BUFFER_SELF, UART_BUFFER_SELF->rxHead, len);
+    uart_rxClaim(UART_BUFFER_SELF, (uart_index_t)(UART_BUFFER_SELF->rxHead + len));
+    uart_rxPublish(UART_BUFFER_SELF, (uart_index_t)(UART_BUFFER_SELF->rxHead + len));
+    UART_STATS_ADD(UART_BUFFER_SELF, rxBytes, len);
+    UART_STATS_PEAK(UART_BUFFER_SELF, uart_rxUsed(UART_BUFFER_SELF));
+    uart_rxCheckHighWatermark(UART_BUFFER_SELF, uart_rxUsed(UART_BUFFER_SELF));
+}
 
-#if defined(UART_MULTIPLE_BUFFERS) && (UART_MULTIPLE_BUFFERS > 0)
-void uart_readBuffer(UARTBuffer *uartBuffer, uint8_t *buffer, size_t len)
+size_t uart_txPeek(UART_BUFFER_PARAM UARTSpan spans[2])
 {
-    for (size_t i = 0; i != len; i++)
-    {
-        while(uart_dataAvailable(uartBuffer)==0);
-        uart_readByteBuffer(uartBuffer, buffer++);
-    } 
+    return uart_txSpans(UART_BUFFER_SELF, spans);
 }
-#else
-void uart_readBuffer( uint8_t *buffer, size_t len)
+
+void uart_txConsume(UART_BUFFER_PARAM size_t len)
 {
-    for (size_t i = 0; i != len; i++)
-    {
-        while(uart_dataAvailable()==0);
-        uart_readByteBuffer( buffer++);
-    } 
+    uart_txRelease(UART_BUFFER_SELF, len);
+}
+
+void uart_flushBuffer(UART_BUFFER_ONLY)
+{
+    // Consumer side only: everything received so far is discarded
+    uart_index_t tail;
+    size_t used = uart_rxSync(UART_BUFFER_SELF, &tail);
+    uart_rxSetTail(UART_BUFFER_SELF, (uart_index_t)(tail + used));
+    UART_TRACE(UART_BUFFER_SELF, UART_TRACE_FLUSH, used);
+}
+
+
+void uart_hardFlushBuffer(UART_BUFFER_ONLY){
+    memset(UART_BUFFER_SELF->rxBuffer,0,UART_BUFFER_SELF->rxSize);
+    uart_flushBuffer(UART_BUFFER_REF(UART_BUFFER_SELF));
+}
+
+#if defined(UART_BUFFER_CAPTURE) && (UART_BUFFER_CAPTURE > 0)
+void uart_setCapture(UART_BUFFER_PARAM struct _UARTCapture *capture)
+{
+    UART_BUFFER_SELF->capture = capture;
 }
 #endif
 
-#if defined(UART_MULTIPLE_BUFFERS) && (UART_MULTIPLE_BUFFERS > 0)
-void uart_flushBuffer(UARTBuffer *uartBuffer)
+#if defined(UART_BUFFER_TIMESTAMP) && (UART_BUFFER_TIMESTAMP > 0)
+void uart_setRxTimestamps(UART_BUFFER_PARAM uint32_t *stamps, uint32_t (*timeNow_callback)(void))
 {
-    uartBuffer->queueEnd = -1;
-    uartBuffer->queueFront = -1;
+    UART_BUFFER_SELF->rxStamps = NULL;  // Handlers stop stamping while reconfiguring
+    UART_BUFFER_SELF->rxStampNow = timeNow_callback;
+    UART_BUFFER_SELF->rxStamps = stamps;
 }
+
+uint32_t uart_rxTimestamp(UART_BUFFER_PARAM size_t offset)
+{
+    uart_index_t tail;
+    uart_rxSync(UART_BUFFER_SELF, &tail);
+    return UART_BUFFER_SELF->rxStamps[(uart_index_t)(tail + offset) & UART_BUFFER_SELF->rxMask];
+}
+#endif
+
+#if defined(UART_BUFFER_READY) && (UART_BUFFER_READY > 0)
+/**
+ * @brief Index of the lowest set bit
+ */
+static inline unsigned uart_readyIndex(uint32_t bit)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return (unsigned)__builtin_ctz(bit);
 #else
-void uart_flushBuffer()
+    unsigned index = 0;
+    while ((bit & 1) == 0)
+    {
+        bit >>= 1;
+        index++;
+    }
+    return index;
+#endif
+}
+
+static inline bool uart_readyRxLevel(UARTBuffer *buffer)
+{
+    return uart_rxUsed(buffer) >= buffer->rxThreshold;
+}
+
+static inline bool uart_readyTxLevel(UARTBuffer *buffer)
+{
+    return buffer->txThreshold != 0 && buffer->txSize - uart_txUsed(buffer) >= buffer->txThreshold;
+}
+
+/**
+ * @brief Revalidates the flagged ports of a level mask. Each bit is cleared before checking its level and set
+ * back if still ready, so a handler raising it in between is never lost
+ * @return uint32_t Ports still ready
+ */
+static uint32_t uart_readyLevels(UARTReadySet *set, uart_mask_t *mask, bool (*level)(UARTBuffer *))
+{
+    uint32_t flagged = UART_MASK_LOAD(*mask);
+    uint32_t ready = 0;
+    while (flagged != 0)
+    {
+        uint32_t bit = flagged & (~flagged + 1);
+        flagged &= ~bit;
+        UART_MASK_AND(*mask, ~bit);
+        UARTBuffer *buffer = set->ports[uart_readyIndex(bit)];
+        if (buffer != NULL && level(buffer))
+        {
+            UART_MASK_OR(*mask, bit);
+            ready |= bit;
+        }
+    }
+    return ready;
+}
+
+void uart_readyInit(UARTReadySet *set, uint32_t (*timeNow_callback)(void), void (*wait_callback)(void *context, uint32_t timeout), void (*wake_callback)(void *context), void *context)
+{
+    memset(set->ports, 0, sizeof(set->ports));
+    UART_MASK_EXCHANGE(set->rx, 0);
+    UART_MASK_EXCHANGE(set->tx, 0);
+    UART_MASK_EXCHANGE(set->delimiter, 0);
+    set->timeNow = timeNow_callback;
+    set->wait = wait_callback;
+    set->wake = wake_callback;
+    set->context = context;
+}
+
+bool uart_setReadySet(UART_BUFFER_PARAM UARTReadySet *set, uint8_t port, size_t rxThreshold, size_t txThreshold, int delimiter)
+{
+    UARTReadySet *previous = UART_BUFFER_SELF->readySet;
+    if (set != NULL && port >= UART_READY_MAX_PORTS)
+        return false;
+    UART_BUFFER_SELF->readySet = NULL;
+    if (previous != NULL)
+    {
+        uint32_t bit = UART_BUFFER_SELF->readyBit;
+        previous->ports[uart_readyIndex(bit)] = NULL;
+        UART_MASK_AND(previous->rx, ~bit);
+        UART_MASK_AND(previous->tx, ~bit);
+        UART_MASK_AND(previous->delimiter, ~bit);
+    }
+    if (set == NULL)
+        return true;
+    UART_BUFFER_SELF->readyBit = (uint32_t)1 << port;
+    UART_BUFFER_SELF->rxThreshold = (rxThreshold != 0) ? rxThreshold : 1;
+    UART_BUFFER_SELF->txThreshold = txThreshold;
+    UART_BUFFER_SELF->readyDelimiter = delimiter;
+    set->ports[port] = UART_BUFFER_SELF;
+    UART_BUFFER_SELF->readySet = set;   // Handlers start flagging from here on
+    if (uart_readyRxLevel(UART_BUFFER_SELF))
+        UART_MASK_OR(set->rx, UART_BUFFER_SELF->readyBit);
+    if (uart_readyTxLevel(UART_BUFFER_SELF))
+        UART_MASK_OR(set->tx, UART_BUFFER_SELF->readyBit);
+    return true;
+}
+
+uint32_t uart_waitAny(UARTReadySet *set, UARTReadyEvents *events, uint32_t timeout)
 {
-    uartBuffer.queueEnd = -1;
-    uartBuffer.queueFront = -1;
+    uint32_t start = (set->timeNow != NULL) ? set->timeNow() : 0;
+    while (true)
+    {
+        events->delimiter = UART_MASK_EXCHANGE(set->delimiter, 0);
+        events->rx = uart_readyLevels(set, &set->rx, uart_readyRxLevel);
+        events->tx = uart_readyLevels(set, &set->tx, uart_readyTxLevel);
+        uint32_t ready = events->rx | events->tx | events->delimiter;
+        if (ready != 0 || timeout == 0)
+            return ready;
+
+        uint32_t remaining = UART_WAIT_FOREVER;
+        if (timeout != UART_WAIT_FOREVER)
+        {
+            if (set->timeNow == NULL)
+                return 0;
+            uint32_t elapsed = set->timeNow() - start;
+            if (elapsed >= timeout)
+                return 0;
+            remaining = timeout - elapsed;
+        }
+        if (set->wait != NULL)
+            set->wait(set->context, remaining);
+    }
 }
 #endif
 
+#if defined(UART_BUFFER_EVENTS) && (UART_BUFFER_EVENTS > 0)
+void uart_setRxEvents(UART_BUFFER_PARAM size_t threshold, int delimiter, void (*event_callback)(void *context, uint8_t events), void (*defer_callback)(void *context), void *context)
+{
+    UART_BUFFER_SELF->rxEvent = NULL;   // Handlers stop reporting while reconfiguring
+    UART_BUFFER_SELF->rxEventThreshold = threshold;
+    UART_BUFFER_SELF->rxEventDelimiter = delimiter;
+    UART_BUFFER_SELF->rxEventDefer = defer_callback;
+    UART_BUFFER_SELF->rxEventContext = context;
+    UART_BUFFER_SELF->rxIdleHead = UART_LOAD_ACQUIRE(UART_BUFFER_SELF->rxHead);
+    UART_MASK_EXCHANGE(UART_BUFFER_SELF->rxEventPending, 0);
+    UART_BUFFER_SELF->rxEvent = event_callback;
+}
 
-#if defined(UART_MULTIPLE_BUFFERS) && (UART_MULTIPLE_BUFFERS > 0)
-void uart_hardFlushBuffer(UARTBuffer *uartBuffer){
-    memset(uartBuffer->rxBuffer,0,UART_RX_BUFFER_SIZE);
-    uart_flushBuffer(uartBuffer);
+void uart_idleInterruptHandler(UART_BUFFER_ONLY)
+{
+    uart_index_t head = UART_BUFFER_SELF->rxHead;   // Only written from the producer context
+    if (UART_BUFFER_SELF->rxEvent == NULL || head == UART_BUFFER_SELF->rxIdleHead)
+        return;
+    UART_BUFFER_SELF->rxIdleHead = head;
+    uart_rxEventRaise(UART_BUFFER_SELF, UART_RX_EVENT_IDLE);
 }
-#else
-void uart_hardFlushBuffer(void){
-    memset(uartBuffer.rxBuffer,0,UART_RX_BUFFER_SIZE);
-    uart_flushBuffer();
+
+uint8_t uart_dispatchRxEvents(UART_BUFFER_ONLY)
+{
+    uint8_t events = (uint8_t)UART_MASK_EXCHANGE(UART_BUFFER_SELF->rxEventPending, 0);
+    if (events != 0 && UART_BUFFER_SELF->rxEvent != NULL)
+        UART_BUFFER_SELF->rxEvent(UART_BUFFER_SELF->rxEventContext, events);
+    return events;
+}
+#endif
+
+#if defined(UART_BUFFER_STATS) && (UART_BUFFER_STATS > 0)
+void uart_getStats(UART_BUFFER_PARAM UARTStats *stats, bool reset)
+{
+    if (stats != NULL)
+        *stats = UART_BUFFER_SELF->stats;
+    if (reset)
+        memset(&UART_BUFFER_SELF->stats, 0, sizeof(UART_BUFFER_SELF->stats));
 }
 #endif
 
 #if defined(UART_BUFFER_LOG) && (UART_BUFFER_LOG > 0)
-#if defined(UART_MULTIPLE_BUFFERS) && (UART_MULTIPLE_BUFFERS > 0)
-void uart_printBuffer(UARTBuffer *uartBuffer){
-    printf("UART buffer print:\n");
-    for (size_t i = 0; i != UART_RX_BUFFER_SIZE; i++)
-    {
-        printf("Index: %u\tValue: 0x%02X\n",i,uartBuffer->rxBuffer[i]);
-    } 
+void uart_setTrace(UART_BUFFER_PARAM struct _UARTTrace *trace, uint8_t port)
+{
+    UART_BUFFER_SELF->trace = NULL;     // Handlers stop tracing while reconfiguring
+    UART_BUFFER_SELF->tracePort = port;
+    UART_BUFFER_SELF->trace = trace;
 }
-#else
-void uart_printBuffer(){
-    printf("UART buffer print:\n");
-    for (size_t i = 0; i != UART_RX_BUFFER_SIZE; i++)
+
+void uart_printBuffer(UART_BUFFER_ONLY){
+    static const char hex[16] = {'0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F'};
+    char line[2 * sizeof(uart_index_t) + 1 + 16 * 3 + 2];   // Offset as wide as uart_index_t and ':', " XX" per byte, '\n' and '\0'
+    UARTSpan spans[2];
+    size_t len = uart_rxPeek(UART_BUFFER_SELF, spans);
+    size_t offset = 0;
+    char *p = line;
+    printf("%s: %lu of %lu bytes\n", UART_BUFFER_TAG, (unsigned long)len, (unsigned long)UART_BUFFER_SELF->rxSize);
+    // Only the unread region is dumped, offsets relative to the oldest byte
+    for (int s = 0; s != 2; s++)
     {
-        printf("i: %3u val: 0x%02X(%c)\n",i,uartBuffer.rxBuffer[i],uartBuffer.rxBuffer[i]);
-    } 
+        for (size_t i = 0; i != spans[s].len; i++, offset++)
+        {
+            uint8_t byte = spans[s].data[i];
+            if ((offset & 15) == 0)
+            {
+                p = line;
+                for (unsigned shift = 8 * sizeof(uart_index_t); shift != 0; shift -= 4)
+                {
+                    *p++ = hex[(offset >> (shift - 4)) & 15];
+                }
+                *p++ = ':';
+            }
+            *p++ = ' ';
+            *p++ = hex[byte >> 4];
+            *p++ = hex[byte & 15];
+            if ((offset & 15) == 15 || offset == len - 1)
+            {
+                *p++ = '\n';
+                *p = '\0';
+                fputs(line, stdout);
+            }
+        }
+    }
 }
-#endif
 #endif
\ No newline at end of file
@@ -27,17 +27,129 @@ extern "C"
 /**
  * @brief Set this macro to a non-zero value to use multiple user-defined UART buffers
  */
+#ifndef UART_MULTIPLE_BUFFERS
 #define UART_MULTIPLE_BUFFERS 0
+#endif
     
 /**
- * @brief Maximum RX buffer size in bytes
+ * @brief Set this macro to zero to remove the embedded RX/TX storage from UARTBuffer. Every buffer must
+ * then be initialized with uart_buffer_initStorage and caller-owned arrays
+ */
+#ifndef UART_BUFFER_STATIC_STORAGE
+#define UART_BUFFER_STATIC_STORAGE 1
+#endif
+
+/**
+ * @brief Embedded RX buffer size in bytes, used by uart_buffer_init. Must be a power of two, since ring indexes are masked instead of compared
  */
-#define UART_RX_BUFFER_SIZE 128				
+#ifndef UART_RX_BUFFER_SIZE
+#define UART_RX_BUFFER_SIZE 128
+#endif
+
+#if (UART_RX_BUFFER_SIZE < 2) || ((UART_RX_BUFFER_SIZE & (UART_RX_BUFFER_SIZE - 1)) != 0)
+#error "UART_RX_BUFFER_SIZE must be a power of two"
+#endif
 
 /**
- * @brief Set this macro to a non-zero value to activate logging functionality.
+ * @brief Embedded TX buffer size in bytes, used by uart_buffer_init. Must be a power of two
  */
+#ifndef UART_TX_BUFFER_SIZE
+#define UART_TX_BUFFER_SIZE 128
+#endif
+
+#if (UART_TX_BUFFER_SIZE < 2) || ((UART_TX_BUFFER_SIZE & (UART_TX_BUFFER_SIZE - 1)) != 0)
+#error "UART_TX_BUFFER_SIZE must be a power of two"
+#endif
+
+/**
+ * @brief Ring index type. Defaults to the native word size so that index updates are single (atomic)
+ * stores: 16 bits on 8/16-bit targets (buffers up to 32 KB) and 32 bits elsewhere (buffers up to 2 GB)
+ */
+#ifndef UART_INDEX_TYPE
+#if UINTPTR_MAX > 0xFFFFu
+#define UART_INDEX_TYPE uint32_t
+#else
+#define UART_INDEX_TYPE uint16_t
+#endif
+#endif
+
+/**
+ * @brief Bits sent on the wire per byte (start + data + parity + stop), used for drain time estimation. 8N1 by default
+ */
+#ifndef UART_FRAME_BITS
+#define UART_FRAME_BITS 10
+#endif
+
+/**
+ * @brief Set this macro to a non-zero value to activate logging functionality: binary event tracing
+ * (see uart_trace.h) and uart_printBuffer
+ */
+#ifndef UART_BUFFER_LOG
 #define UART_BUFFER_LOG 0
+#endif
+
+/**
+ * @brief Set this macro to a non-zero value to allow computing CRCs while data is copied in or out of
+ * UART buffers (see uart_setCrc and uart_crc.h). uart_crc.c must then be built too
+ */
+#ifndef UART_BUFFER_CRC
+#define UART_BUFFER_CRC 0
+#endif
+
+/**
+ * @brief Set this macro to a non-zero value to keep runtime statistics in every UART buffer (see UARTStats)
+ */
+#ifndef UART_BUFFER_STATS
+#define UART_BUFFER_STATS 0
+#endif
+
+/**
+ * @brief Set this macro to zero to build uart_dataAvailable, uart_firstByteReceived, uart_lastByteReceived
+ * and uart_popByte out of line instead of as header inline functions (e.g. to call them through the ABI
+ * from other languages)
+ */
+#ifndef UART_BUFFER_INLINE
+#define UART_BUFFER_INLINE 1
+#endif
+
+/**
+ * @brief Set this macro to a non-zero value to allow recording received traffic (see uart_capture.h)
+ */
+#ifndef UART_BUFFER_CAPTURE
+#define UART_BUFFER_CAPTURE 0
+#endif
+
+/**
+ * @brief Set this macro to a non-zero value to let reception/transmission handlers flag buffers in a
+ * readiness set (see UARTReadySet and uart_waitAny)
+ */
+#ifndef UART_BUFFER_READY
+#define UART_BUFFER_READY 0
+#endif
+
+/**
+ * @brief Set this macro to a non-zero value to let reception handlers fire callbacks on byte count
+ * threshold, delimiter arrival and line idle (see uart_setRxEvents)
+ */
+#ifndef UART_BUFFER_EVENTS
+#define UART_BUFFER_EVENTS 0
+#endif
+
+/**
+ * @brief Set this macro to a non-zero value to allow stamping every received byte with its arrival time
+ * (see uart_setRxTimestamps and uart_rtu.h)
+ */
+#ifndef UART_BUFFER_TIMESTAMP
+#define UART_BUFFER_TIMESTAMP 0
+#endif
+
+#if defined(UART_BUFFER_CRC) && (UART_BUFFER_CRC > 0)
+#include "uart_crc.h"
+#endif
+
+struct _UARTCapture;
+struct _UARTReadySet;
+struct _UARTTrace;
     
 static const char* UART_BUFFER_TAG = "UART-buffer";
 
@@ -48,283 +160,1045 @@ typedef enum _UART_rxQueue_Status{
 } UART_rxQueue_Status;
 
 /**
- * @brief Data structure definition for UART FIFO buffer
+ * @brief RX ring behaviour when a byte arrives and the ring is full
+ */
+typedef enum _UART_OverflowPolicy{
+    UART_OVERFLOW_OVERWRITE = 0,    // Oldest byte is discarded (default)
+    UART_OVERFLOW_DROP_NEWEST,      // Received byte is discarded
+    UART_OVERFLOW_BACKPRESSURE      // Peer is stopped at high watermark and resumed at low watermark through flowControl callback. Drops newest if it doesn't stop in time
+} UART_OverflowPolicy;
+
+/**
+ * @brief Software flow control characters, for flowControl callbacks implementing XON/XOFF
+ */
+#define UART_XON  0x11
+#define UART_XOFF 0x13
+
+/**
+ * @brief Contiguous region inside a ring buffer. Ring contents may be split in two spans at the wrap-around point
+ */
+typedef struct _UARTSpan{
+    uint8_t *data;
+    size_t len;
+} UARTSpan;
+
+/**
+ * @brief Default line delimiter for UARTLineReader
+ */
+#ifndef UART_LINE_DELIMITER
+#define UART_LINE_DELIMITER '\n'
+#endif
+
+/**
+ * @brief Runtime statistics, to size buffers from field data. Counters wrap around; each one is written
+ * from a single context (producer, consumer or writer), so a snapshot is consistent per counter only
+ */
+typedef struct _UARTStats{
+    uint32_t rxBytes;           // Bytes delivered by the RX interrupt/DMA (including dropped ones)
+    uint32_t txBytes;           // Bytes written (queued in TX ring or sent synchronously)
+    uint32_t rxDropped;         // Newest bytes discarded on full ring (drop-newest/backpressure policies)
+    uint32_t rxOverwritten;     // Oldest bytes lost on full ring (overwrite policy), detected by the reader
+    uint32_t rxPeak;            // Highest RX ring fill level seen by the producer
+    uint32_t rxInterrupts;      // uart_interruptHandler/uart_burstInterruptHandler calls
+    uint32_t txInterrupts;      // uart_txInterruptHandler calls
+    uint32_t waits;             // Blocking reads that found the ring empty and had to wait
+    uint32_t waitTime;          // Total reader wait time in microseconds (needs timeNow hook)
+} UARTStats;
+
+/**
+ * @brief Timeout value for blocking reads that never expire
+ */
+#define UART_WAIT_FOREVER   UINT32_MAX
+
+/**
+ * @brief Reception events reported to the uart_setRxEvents callback (bit flags)
+ */
+typedef enum _UART_RxEvent{
+    UART_RX_EVENT_THRESHOLD = 0x01,     // Fill level crossed the threshold
+    UART_RX_EVENT_DELIMITER = 0x02,     // Delimiter byte received
+    UART_RX_EVENT_IDLE = 0x04,          // Line went idle after receiving data
+} UART_RxEvent;
+
+/**
+ * @brief uart_setRxEvents delimiter value disabling delimiter events
+ */
+#define UART_RX_EVENT_NO_DELIMITER (-1)
+
+/**
+ * @brief Incremental line assembler state. Keeps a partially received line between non-blocking calls
+ */
+typedef struct _UARTLineReader{
+    char *line;         // Caller-owned storage for assembled line
+    size_t size;        // Storage size in bytes (including NUL terminator)
+    size_t len;         // Bytes of current line assembled so far
+    size_t scanned;     // Ring bytes already searched by uart_peekLine
+    uint8_t delimiter;
+    bool truncated;     // Last returned line didn't fit and has no delimiter
+} UARTLineReader;
+
+/**
+ * @brief Free-running ring index type. Indexes are never wrapped, only masked when accessing rxBuffer
+ */
+typedef UART_INDEX_TYPE uart_index_t;
+
+/**
+ * @brief Largest ring capacity supported by uart_index_t (half its range, so that overruns can be detected)
+ */
+#define UART_MAX_CAPACITY ((size_t)((uart_index_t)~(uart_index_t)0 >> 1) + 1)
+
+/*
+ * Ring index publication. The producer stores rxHead with release semantics after writing the data
+ * byte and the consumer loads it with acquire semantics before reading it (and the other way around
+ * for rxTail), so no lock or interrupt masking is required. On single core targets without atomics
+ * support, volatile accesses are enough. The fences order ring data accesses around rxClaim (see UARTBuffer).
+ */
+#if defined(__GNUC__) || defined(__clang__)
+#define UART_LOAD_ACQUIRE(index) __atomic_load_n(&(index), __ATOMIC_ACQUIRE)
+#define UART_STORE_RELEASE(index, value) __atomic_store_n(&(index), (value), __ATOMIC_RELEASE)
+#define UART_FENCE_ACQUIRE() __atomic_thread_fence(__ATOMIC_ACQUIRE)
+#define UART_FENCE_RELEASE() __atomic_thread_fence(__ATOMIC_RELEASE)
+#elif defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 201112L) && !defined(__STDC_NO_ATOMICS__)
+#include <stdatomic.h>
+#define UART_LOAD_ACQUIRE(index) uart_loadAcquire(&(index))
+#define UART_STORE_RELEASE(index, value) uart_storeRelease(&(index), (value))
+#define UART_FENCE_ACQUIRE() atomic_thread_fence(memory_order_acquire)
+#define UART_FENCE_RELEASE() atomic_thread_fence(memory_order_release)
+static inline uart_index_t uart_loadAcquire(volatile uart_index_t *index)
+{
+    uart_index_t value = *index;
+    atomic_thread_fence(memory_order_acquire);
+    return value;
+}
+static inline void uart_storeRelease(volatile uart_index_t *index, uart_index_t value)
+{
+    atomic_thread_fence(memory_order_release);
+    *index = value;
+}
+#else
+#define UART_LOAD_ACQUIRE(index) (index)
+#define UART_STORE_RELEASE(index, value) ((index) = (value))
+#define UART_FENCE_ACQUIRE() ((void)0)
+#define UART_FENCE_RELEASE() ((void)0)
+#endif
+
+/*
+ * Atomic read-modify-write on event bit masks (set from interrupt context, cleared by the waiting task).
+ * Each macro returns the previous mask value. Without atomics support they are plain read-modify-write
+ * sequences, only safe if the task side runs with interrupts masked.
+ */
+#if defined(__GNUC__) || defined(__clang__)
+typedef volatile uint32_t uart_mask_t;
+#define UART_MASK_LOAD(mask) __atomic_load_n(&(mask), __ATOMIC_ACQUIRE)
+#define UART_MASK_OR(mask, bits) __atomic_fetch_or(&(mask), (bits), __ATOMIC_ACQ_REL)
+#define UART_MASK_AND(mask, bits) __atomic_fetch_and(&(mask), (bits), __ATOMIC_ACQ_REL)
+#define UART_MASK_EXCHANGE(mask, value) __atomic_exchange_n(&(mask), (value), __ATOMIC_ACQ_REL)
+#elif defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 201112L) && !defined(__STDC_NO_ATOMICS__)
+typedef _Atomic uint32_t uart_mask_t;
+#define UART_MASK_LOAD(mask) atomic_load(&(mask))
+#define UART_MASK_OR(mask, bits) atomic_fetch_or(&(mask), (bits))
+#define UART_MASK_AND(mask, bits) atomic_fetch_and(&(mask), (bits))
+#define UART_MASK_EXCHANGE(mask, value) atomic_exchange(&(mask), (value))
+#else
+typedef volatile uint32_t uart_mask_t;
+static inline uint32_t uart_maskUpdate(uart_mask_t *mask, uint32_t value)
+{
+    uint32_t previous = *mask;
+    *mask = value;
+    return previous;
+}
+#define UART_MASK_LOAD(mask) (mask)
+#define UART_MASK_OR(mask, bits) uart_maskUpdate(&(mask), (mask) | (bits))
+#define UART_MASK_AND(mask, bits) uart_maskUpdate(&(mask), (mask) & (bits))
+#define UART_MASK_EXCHANGE(mask, value) uart_maskUpdate(&(mask), (value))
+#endif
+
+/**
+ * @brief Data structure definition for UART FIFO buffer (single producer, single consumer ring)
+ * 
+ * rxHead is only written by the interrupt handler (producer) and rxTail only by the reader (consumer),
+ * so both sides can run concurrently without disabling interrupts. When the producer laps the consumer
+ * the oldest bytes are discarded by the consumer on its next access. Under overwrite policy the producer
+ * also publishes rxClaim (end of the region it's about to write) before writing, and readers check it
+ * after copying: bytes the producer may have overwritten meanwhile are dropped and counted, never returned.
+ * 
+ * The TX ring works the other way around: txHead is written by the application and txTail by the
+ * TX-empty interrupt handler. It's only used once uart_txInit has provided a txInterruptEnable callback,
+ * otherwise bytes are sent synchronously through writeByte.
+ * 
+ * rxBuffer/txBuffer point either to the embedded storage or to caller-owned arrays (uart_buffer_initStorage),
+ * so each port can have its own capacity.
  */
 typedef struct _UARTBuffer{
-    uint8_t rxBuffer[UART_RX_BUFFER_SIZE];
-    volatile int16_t queueFront;		
-    volatile int16_t queueEnd;	
+    uint8_t *rxBuffer;
+    uart_index_t rxSize;
+    uart_index_t rxMask;            // rxSize - 1
+    volatile uart_index_t rxHead;   // Next position to be written by the interrupt handler
+    volatile uart_index_t rxTail;   // Next position to be read
+    volatile uart_index_t rxClaim;  // Overwrite policy: end of the region being written by the interrupt handler (rxHead when idle)
+    uint8_t *txBuffer;
+    uart_index_t txSize;
+    uart_index_t txMask;            // txSize - 1
+    volatile uart_index_t txHead;   // Next position to be written by the application
+    volatile uart_index_t txTail;   // Next position to be sent by the TX interrupt handler
+    uint32_t baudRate;
     void (*writeByte)(uint8_t);
     uint8_t (*readByte)(void);
+    size_t (*readBytes)(uint8_t *, size_t);
+    void (*txInterruptEnable)(bool);
+    UART_OverflowPolicy overflowPolicy;
+    size_t highWatermark;
+    size_t lowWatermark;
+    volatile bool flowStopped;      // Set by the interrupt handler at high watermark, cleared by the reader at low watermark
+    void (*flowControl)(bool);
+    uint32_t (*timeNow)(void);      // Free-running microsecond clock for read deadlines
+    void (*rxWait)(void *, uint32_t);   // Sleeps until rxWake or timeout (us) elapses. Must remember wakes given before waiting
+    void (*rxWake)(void *);         // Called from reception handlers after new data is published
+    void *waitContext;              // Passed to rxWait/rxWake (semaphore, eventfd...)
+#if defined(UART_BUFFER_CRC) && (UART_BUFFER_CRC > 0)
+    UARTCrc *rxCrc;                 // Updated with data read through uart_readBuffer/uart_read/uart_readAvailable/uart_readByteBuffer/uart_getLine
+    UARTCrc *txCrc;                 // Updated with data sent through write functions
+#endif
+#if defined(UART_BUFFER_STATS) && (UART_BUFFER_STATS > 0)
+    UARTStats stats;
+#endif
+#if defined(UART_BUFFER_CAPTURE) && (UART_BUFFER_CAPTURE > 0)
+    struct _UARTCapture *capture;   // Records every received byte with its timestamp
+#endif
+#if defined(UART_BUFFER_LOG) && (UART_BUFFER_LOG > 0)
+    struct _UARTTrace *trace;       // Event trace (NULL if none)
+    uint8_t tracePort;              // Port number in trace records
+#endif
+#if defined(UART_BUFFER_READY) && (UART_BUFFER_READY > 0)
+    struct _UARTReadySet *readySet; // Readiness set flagged by the handlers (NULL if none)
+    uint32_t readyBit;              // Bit of this buffer in readySet masks
+    size_t rxThreshold;             // RX fill level (bytes) that makes the buffer ready to read
+    size_t txThreshold;             // TX free space (bytes) that makes the buffer ready to write (0: not watched)
+    int readyDelimiter;             // Byte reported on arrival, or UART_READY_NO_DELIMITER
+#endif
+#if defined(UART_BUFFER_EVENTS) && (UART_BUFFER_EVENTS > 0)
+    void (*rxEvent)(void *, uint8_t);   // Called with UART_RxEvent flags (NULL: events disabled)
+    void (*rxEventDefer)(void *);   // Schedules uart_dispatchRxEvents in task context (NULL: rxEvent runs in the handler)
+    void *rxEventContext;           // Passed to rxEvent/rxEventDefer
+    size_t rxEventThreshold;        // Fill level reported when crossed (0: not watched)
+    int rxEventDelimiter;           // Byte reported on arrival, or UART_RX_EVENT_NO_DELIMITER
+    uart_index_t rxIdleHead;        // rxHead at the last idle event
+    uart_mask_t rxEventPending;     // Events waiting for uart_dispatchRxEvents
+#endif
+#if defined(UART_BUFFER_TIMESTAMP) && (UART_BUFFER_TIMESTAMP > 0)
+    uint32_t *rxStamps;             // Arrival time of every ring byte, same index as rxBuffer (NULL: not stamped)
+    uint32_t (*rxStampNow)(void);   // Free-running microsecond clock read by the reception handlers
+#endif
+#if defined(UART_BUFFER_STATIC_STORAGE) && (UART_BUFFER_STATIC_STORAGE > 0)
+    uint8_t rxStorage[UART_RX_BUFFER_SIZE];
+    uint8_t txStorage[UART_TX_BUFFER_SIZE];
+#endif
 } UARTBuffer;
 
 
 #if defined(UART_MULTIPLE_BUFFERS) && (UART_MULTIPLE_BUFFERS > 0)
-
+/*
+ * Public functions take the UART buffer as first parameter only with UART_MULTIPLE_BUFFERS; otherwise
+ * they work on the single static buffer. These macros let every function be declared and implemented once:
+ * UART_BUFFER_PARAM/UART_BUFFER_ONLY in parameter lists, UART_BUFFER_ARG(buffer)/UART_BUFFER_REF(buffer)
+ * in calls and UART_BUFFER_SELF (inside implementations) as the buffer reference
+ */
+#define UART_BUFFER_PARAM           UARTBuffer *uartBuffer,
+#define UART_BUFFER_ONLY            UARTBuffer *uartBuffer
+#define UART_BUFFER_ARG(buffer)     buffer,
+#define UART_BUFFER_REF(buffer)     buffer
+#define UART_BUFFER_SELF            uartBuffer
 #else
 /**
- * @brief Single UART buffer
+ * @brief Single UART buffer (defined in uart_buffer.c, so that inline functions and the library share it)
+ */
+extern UARTBuffer uartBuffer;
+
+#define UART_BUFFER_PARAM
+#define UART_BUFFER_ONLY            void
+#define UART_BUFFER_ARG(buffer)
+#define UART_BUFFER_REF(buffer)
+#define UART_BUFFER_SELF            (&uartBuffer)
+#endif
+
+#if defined(UART_BUFFER_READY) && (UART_BUFFER_READY > 0)
+/**
+ * @brief Maximum UART buffer quantity per readiness set (one bit each)
+ */
+#define UART_READY_MAX_PORTS 32
+
+/**
+ * @brief readyDelimiter value disabling delimiter events
  */
-static UARTBuffer uartBuffer;
+#define UART_READY_NO_DELIMITER (-1)
+
+/**
+ * @brief Ready ports, one bit per port index
+ */
+typedef struct _UARTReadyEvents{
+    uint32_t rx;            // At least rxThreshold bytes to read (level)
+    uint32_t tx;            // At least txThreshold bytes of TX ring space (level)
+    uint32_t delimiter;     // Delimiter received since last reported (edge)
+} UARTReadyEvents;
+
+/**
+ * @brief Readiness set shared by several UART buffers. Handlers set the port bits with atomic operations and
+ * wake the waiting task, so uart_waitAny only visits flagged ports instead of polling all of them
+ */
+typedef struct _UARTReadySet{
+    UARTBuffer *ports[UART_READY_MAX_PORTS];
+    uart_mask_t rx;
+    uart_mask_t tx;
+    uart_mask_t delimiter;
+    uint32_t (*timeNow)(void);          // Free-running microsecond clock for uart_waitAny timeouts
+    void (*wait)(void *, uint32_t);     // Sleeps until wake or timeout (us) elapses. Must remember wakes given before waiting
+    void (*wake)(void *);               // Called from handlers when a port becomes ready
+    void *context;                      // Passed to wait/wake
+} UARTReadySet;
 #endif
 
+/**
+ * @brief Bytes stored in the ring, without modifying any index (safe from any context). The overrun clamp
+ * is a plain select, so it compiles to a conditional move instead of a branch
+ */
+static inline size_t uart_rxUsed(UARTBuffer *buffer)
+{
+    uart_index_t used = (uart_index_t)(UART_LOAD_ACQUIRE(buffer->rxHead) - UART_LOAD_ACQUIRE(buffer->rxTail));
+    return (used > buffer->rxSize) ? buffer->rxSize : used;
+}
+
+/**
+ * @brief Under overwrite policy, how many of 'count' bytes read from free-running index 'tail' the producer
+ * may have overwritten while they were being read (the oldest ones). Must be called after reading them
+ */
+static inline size_t uart_rxLapped(UARTBuffer *buffer, uart_index_t tail, size_t count)
+{
+    if (buffer->overflowPolicy != UART_OVERFLOW_OVERWRITE)
+        return 0;
+    UART_FENCE_ACQUIRE();
+    uart_index_t ahead = (uart_index_t)(UART_LOAD_ACQUIRE(buffer->rxClaim) - tail);
+    if (ahead <= buffer->rxSize)
+        return 0;
+    size_t lost = (size_t)(ahead - buffer->rxSize);
+    return (lost > count) ? count : lost;
+}
+
 #pragma region Function prototypes
 
-#if defined(UART_MULTIPLE_BUFFERS) && (UART_MULTIPLE_BUFFERS > 0)
+#if defined(UART_BUFFER_STATIC_STORAGE) && (UART_BUFFER_STATIC_STORAGE > 0)
 /**
  * @brief UART buffer initialization (Multiple UART buffers)
- * @param uartBuffer Reference to UART buffer 
+ * @param uartBuffer Reference to UART buffer (parameter only present with UART_MULTIPLE_BUFFERS)
  * @param writeByte_callback Reference to writeByte callback function
  * @param readByte_callback Reference to readByte callback function
  */
-void uart_buffer_init(UARTBuffer *uartBuffer, void (*writeByte_callback)(uint8_t), uint8_t (*readByte_callback)(void));
-#else
+void uart_buffer_init(UART_BUFFER_PARAM void (*writeByte_callback)(uint8_t), uint8_t (*readByte_callback)(void));
+#endif
+
 /**
- * @brief UART buffer initialization (Single UART buffer)
+ * @brief UART buffer initialization with caller-owned storage (Multiple UART buffers)
+ * @param uartBuffer Reference to UART buffer (parameter only present with UART_MULTIPLE_BUFFERS)
+ * @param rxStorage Reference to RX storage array
+ * @param rxSize RX storage size in bytes. Must be a power of two not greater than UART_MAX_CAPACITY
+ * @param txStorage Reference to TX storage array
+ * @param txSize TX storage size in bytes. Must be a power of two not greater than UART_MAX_CAPACITY
  * @param writeByte_callback Reference to writeByte callback function
  * @param readByte_callback Reference to readByte callback function
+ * @return true Initialization succeeded
+ * @return false Invalid storage size
+ */
+bool uart_buffer_initStorage(UART_BUFFER_PARAM uint8_t *rxStorage, size_t rxSize, uint8_t *txStorage, size_t txSize, void (*writeByte_callback)(uint8_t), uint8_t (*readByte_callback)(void));
+
+/**
+ * @brief Selects what happens when a byte is received and RX buffer is full. For UART_OVERFLOW_BACKPRESSURE,
+ * flowControl_callback(true) is called (from interrupt context) when fill level reaches highWatermark, and
+ * flowControl_callback(false) (from reader context) when it drops to lowWatermark, to drive RTS or send XOFF/XON
+ * @param uartBuffer Reference to UART buffer (parameter only present with UART_MULTIPLE_BUFFERS)
+ * @param policy Overflow policy
+ * @param highWatermark Fill level (bytes) at which the peer is stopped
+ * @param lowWatermark Fill level (bytes) at which the peer is resumed
+ * @param flowControl_callback Reference to flow control function (true: stop peer, false: resume peer). Required for UART_OVERFLOW_BACKPRESSURE
  */
-void uart_buffer_init(void (*writeByte_callback)(uint8_t), uint8_t (*readByte_callback)(void));
+void uart_setOverflowPolicy(UART_BUFFER_PARAM UART_OverflowPolicy policy, size_t highWatermark, size_t lowWatermark, void (*flowControl_callback)(bool));
+
+#if defined(UART_BUFFER_CRC) && (UART_BUFFER_CRC > 0)
+/**
+ * @brief Attaches running CRCs to UART buffer, so that checksums are computed while data is copied in or out
+ * (no extra pass over it)
+ * @param uartBuffer Reference to UART buffer (parameter only present with UART_MULTIPLE_BUFFERS)
+ * @param rxCrc Reference to CRC updated with data read from UART buffer (NULL to disable)
+ * @param txCrc Reference to CRC updated with data written to UART (NULL to disable)
+ */
+void uart_setCrc(UART_BUFFER_PARAM UARTCrc *rxCrc, UARTCrc *txCrc);
 #endif
 
-#if defined(UART_MULTIPLE_BUFFERS) && (UART_MULTIPLE_BUFFERS > 0)
 /**
- * @brief Sends a string of characters through UART
- * 
- * @param uartBuffer Reference to UART buffer 
- * @param str String of characters to be send
+ * @brief Registers hooks used by blocking reads. Without rxWait readers spin; without timeNow only
+ * UART_WAIT_FOREVER reads wait (finite timeouts make a single attempt).
+ * Typical rxWait/rxWake pairs: WFI + empty wake, RTOS semaphore take/give (give is ISR-safe), eventfd/futex
+ * @param uartBuffer Reference to UART buffer (parameter only present with UART_MULTIPLE_BUFFERS)
+ * @param timeNow_callback Reference to microsecond clock function (NULL if none)
+ * @param rxWait_callback Reference to wait function, receiving context and remaining time in microseconds (NULL to spin)
+ * @param rxWake_callback Reference to wake function, called from interrupt context (NULL if none)
+ * @param context Opaque reference passed to wait and wake functions
  */
-void uart_puts(UARTBuffer *uartBuffer, const char *str);
-#else
+void uart_setWaitHooks(UART_BUFFER_PARAM uint32_t (*timeNow_callback)(void), void (*rxWait_callback)(void *context, uint32_t timeout), void (*rxWake_callback)(void *context), void *context);
+
+/**
+ * @brief Enables interrupt-driven transmission. Write functions will queue data in the TX buffer and
+ * return, and uart_txInterruptHandler will send it through writeByte
+ * @param uartBuffer Reference to UART buffer (parameter only present with UART_MULTIPLE_BUFFERS)
+ * @param txInterruptEnable_callback Reference to function that enables (true) or disables (false) the TX-empty interrupt
+ * @param baudRate UART baud rate, used for drain time estimation
+ */
+void uart_txInit(UART_BUFFER_PARAM void (*txInterruptEnable_callback)(bool), uint32_t baudRate);
+
+/**
+ * @brief Registers a multi-byte read callback, used by uart_burstInterruptHandler to drain the whole
+ * hardware FIFO at once
+ * @param uartBuffer Reference to UART buffer (parameter only present with UART_MULTIPLE_BUFFERS)
+ * @param readBytes_callback Reference to function that copies up to 'max' received bytes to 'data' and returns how many were copied
+ */
+void uart_rxBurstInit(UART_BUFFER_PARAM size_t (*readBytes_callback)(uint8_t *data, size_t max));
+
 /**
  * @brief Sends a string of characters through UART
+ * 
+ * @param uartBuffer Reference to UART buffer (parameter only present with UART_MULTIPLE_BUFFERS)
  * @param str String of characters to be send
  */
-void uart_puts(const char *str);
-#endif
+void uart_puts(UART_BUFFER_PARAM const char *str);
 
-#if defined(UART_MULTIPLE_BUFFERS) && (UART_MULTIPLE_BUFFERS > 0)
 /**
- * @brief Gets a string of characters through UART
- * @param uartBuffer Reference to UART buffer
+ * @brief Gets a string of characters through UART, waiting until a line delimiter (LF) is received.
+ * Line is stored NUL terminated and including its delimiter (and CR, if any)
+ * @param uartBuffer Reference to UART buffer (parameter only present with UART_MULTIPLE_BUFFERS)
  * @param buffer Reference to char array that will store the received characters
- * @param len Max byte quantity to read
- * @return 
+ * @param len Max byte quantity to read (including NUL terminator)
+ * @return char* buffer, or NULL if line was too long (buffer holds its first len - 1 bytes) or len is 0
  */
-char *uart_gets(UARTBuffer *uartBuffer, char *buffer, size_t len);
-#else
+char *uart_gets(UART_BUFFER_PARAM char *buffer, size_t len);
+
 /**
- * @brief Gets a string of characters through UART
+ * @brief Same as uart_gets, giving up after 'timeout' microseconds
+ * @param uartBuffer Reference to UART buffer (parameter only present with UART_MULTIPLE_BUFFERS)
  * @param buffer Reference to char array that will store the received characters
- * @param len Max byte quantity to read
- * @return 
+ * @param len Max byte quantity to read (including NUL terminator)
+ * @param timeout Timeout in microseconds, or UART_WAIT_FOREVER
+ * @return char* buffer, or NULL on timeout (partial line is discarded), if line was too long or len is 0
  */
-char *uart_gets(char *buffer, size_t len);
-#endif
+char *uart_getsTimeout(UART_BUFFER_PARAM char *buffer, size_t len, uint32_t timeout);
 
-#if defined(UART_MULTIPLE_BUFFERS) && (UART_MULTIPLE_BUFFERS > 0)
 /**
- * @brief Sends a string of characters through UART appending CR & LF
- * 
- * @param uartBuffer Reference to UART buffer 
- * @param str String of characters to be send
+ * @brief Line reader initialization
+ * @param reader Reference to line reader
+ * @param buffer Reference to char array that will store assembled lines
+ * @param size Size of buffer in bytes (including NUL terminator). With 0, uart_getLine always returns NULL
+ * @param delimiter Line delimiter byte (usually UART_LINE_DELIMITER)
  */
-void uart_writeLine(UARTBuffer *uartBuffer, const char *str);
-#else
+void uart_lineReaderInit(UARTLineReader *reader, char *buffer, size_t size, uint8_t delimiter);
+
 /**
- * @brief Sends a string of characters through UART appending CR & LF
- * 
- * @param str String of characters to be send
+ * @brief Non-blocking line reception. Moves received data into the line reader storage in bulk (searching
+ * the delimiter with memchr) and keeps partial lines between calls
+ * @param uartBuffer Reference to UART buffer (parameter only present with UART_MULTIPLE_BUFFERS)
+ * @param reader Reference to line reader
+ * @return char* NUL terminated line (including delimiter) once complete or once storage is full (reader->truncated set), NULL otherwise
  */
-void uart_writeLine(const char *str);
-#endif
+char *uart_getLine(UART_BUFFER_PARAM UARTLineReader *reader);
 
-#if defined(UART_MULTIPLE_BUFFERS) && (UART_MULTIPLE_BUFFERS > 0)
 /**
- * @brief Sends a byte buffer through UART
+ * @brief Blocking version of uart_getLine, waiting up to 'timeout' microseconds for line completion.
+ * A partial line stays in the reader on timeout, so reception can be resumed later
+ * @param uartBuffer Reference to UART buffer (parameter only present with UART_MULTIPLE_BUFFERS)
+ * @param reader Reference to line reader
+ * @param timeout Timeout in microseconds, or UART_WAIT_FOREVER
+ * @return char* NUL terminated line as uart_getLine, NULL on timeout
+ */
+char *uart_getLineTimeout(UART_BUFFER_PARAM UARTLineReader *reader, uint32_t timeout);
+
+/**
+ * @brief Zero-copy, non-blocking line reception. If a complete line is in UART buffer, exposes it in place
+ * as up to two spans; it must be released with uart_consume afterwards. Only data received since the previous
+ * call is searched (line reader storage isn't used)
+ * @param uartBuffer Reference to UART buffer (parameter only present with UART_MULTIPLE_BUFFERS)
+ * @param reader Reference to line reader
+ * @param spans Array of two spans to be filled
+ * @return size_t Line length including delimiter, or 0 if no complete line is available
+ */
+size_t uart_peekLine(UART_BUFFER_PARAM UARTLineReader *reader, UARTSpan spans[2]);
+
+/**
+ * @brief Sends a string of characters through UART appending CR & LF
  * 
- * @param uartBuffer Reference to UART buffer 
- * @param buffer Byte buffer to be send
- * @param len Byte quantity to send
+ * @param uartBuffer Reference to UART buffer (parameter only present with UART_MULTIPLE_BUFFERS)
+ * @param str String of characters to be send
  */
-void uart_writeBuffer(UARTBuffer *uartBuffer, uint8_t *buffer, size_t len); 
-#else
+void uart_writeLine(UART_BUFFER_PARAM const char *str);
+
 /**
  * @brief Sends a byte buffer through UART
+ *
+ * @param uartBuffer Reference to UART buffer (parameter only present with UART_MULTIPLE_BUFFERS)
  * @param buffer Byte buffer to be send
  * @param len Byte quantity to send
  */
-void uart_writeBuffer( uint8_t *buffer, size_t len); 
-#endif
+void uart_writeBuffer(UART_BUFFER_PARAM uint8_t *buffer, size_t len);
 
-#if defined(UART_MULTIPLE_BUFFERS) && (UART_MULTIPLE_BUFFERS > 0)
 /**
  * @brief Sends data (any type) through UART. Internally, data providen will be casted to an array of bytes
  * 
- * @param uartBuffer Reference to UART buffer 
+ * @param uartBuffer Reference to UART buffer (parameter only present with UART_MULTIPLE_BUFFERS)
  * @param data Reference to data that is going to be sended
  * @param len Byte quantity to be send
  */
-void uart_write(UARTBuffer *uartBuffer, void* data, size_t len);
-#else
+void uart_write(UART_BUFFER_PARAM void* data, size_t len);
+
 /**
- * @brief Sends data (any type) through UART. Internally, data providen will be casted to an array of bytes
+ * @brief Queues up to 'len' bytes in the TX buffer without waiting for free space
+ * 
+ * @param uartBuffer Reference to UART buffer (parameter only present with UART_MULTIPLE_BUFFERS)
  * @param data Reference to data that is going to be sended
- * @param len Byte quantity to be send
+ * @param len Max byte quantity to be send
+ * @return size_t Byte quantity actually queued (sent synchronously if uart_txInit wasn't called)
  */
-void uart_write(void* data, size_t len);
-#endif
+size_t uart_writeAsync(UART_BUFFER_PARAM const void *data, size_t len);
+
+/**
+ * @brief Returns free space in TX buffer
+ * @param uartBuffer Reference to UART buffer (parameter only present with UART_MULTIPLE_BUFFERS)
+ * @return size_t Bytes that can be queued without waiting
+ */
+size_t uart_txSpace(UART_BUFFER_ONLY);
+
+/**
+ * @brief Returns bytes queued in TX buffer that haven't been sent yet
+ * @param uartBuffer Reference to UART buffer (parameter only present with UART_MULTIPLE_BUFFERS)
+ * @return size_t Pending bytes in TX buffer
+ */
+size_t uart_txPending(UART_BUFFER_ONLY);
+
+/**
+ * @brief Estimates time needed to send all bytes queued in TX buffer at the configured baud rate
+ * @param uartBuffer Reference to UART buffer (parameter only present with UART_MULTIPLE_BUFFERS)
+ * @return uint32_t Drain time in microseconds (0 if baud rate is unknown)
+ */
+uint32_t uart_txDrainTime(UART_BUFFER_ONLY);
 
-#if defined(UART_MULTIPLE_BUFFERS) && (UART_MULTIPLE_BUFFERS > 0)
 /**
  * @brief Receives data (any type) through UART. Internally, data providen will be casted to an array of bytes
  * 
- * @param uartBuffer Reference to UART buffer 
+ * @param uartBuffer Reference to UART buffer (parameter only present with UART_MULTIPLE_BUFFERS)
  * @param data Reference to data that is going to be received
  * @param len Byte quantity to be received
  */
-void uart_read(UARTBuffer *uartBuffer, void* data, size_t len);
-#else
-void uart_read(void* data, size_t len);
-#endif
+void uart_read(UART_BUFFER_PARAM void* data, size_t len);
+
+/**
+ * @brief Receives data (any type) through UART, giving up after 'timeout' microseconds
+ * @param uartBuffer Reference to UART buffer (parameter only present with UART_MULTIPLE_BUFFERS)
+ * @param data Reference to data that is going to be received
+ * @param len Byte quantity to be received
+ * @param timeout Timeout in microseconds, or UART_WAIT_FOREVER
+ * @return size_t Byte quantity actually received (less than len on timeout)
+ */
+size_t uart_readTimeout(UART_BUFFER_PARAM void* data, size_t len, uint32_t timeout);
 
-#if defined(UART_MULTIPLE_BUFFERS) && (UART_MULTIPLE_BUFFERS > 0)
 /**
  * @brief Serial reception interrupt handler
  * 
- * @param uartBuffer Reference to UART buffer 
+ * @param uartBuffer Reference to UART buffer (parameter only present with UART_MULTIPLE_BUFFERS)
  */
-void uart_interruptHandler(UARTBuffer *uartBuffer);
-#else
+void uart_interruptHandler(UART_BUFFER_ONLY);
+
 /**
- * @brief Serial reception interrupt handler
+ * @brief Serial reception interrupt handler for UARTs with hardware FIFO. Drains everything readBytes
+ * returns (up to UART_RX_BUFFER_SIZE bytes) straight into the ring and publishes it once
+ * 
+ * @param uartBuffer Reference to UART buffer (parameter only present with UART_MULTIPLE_BUFFERS)
+ * @return size_t Received byte quantity
  */
-void uart_interruptHandler(void);
-#endif
+size_t uart_burstInterruptHandler(UART_BUFFER_ONLY);
 
-#if defined(UART_MULTIPLE_BUFFERS) && (UART_MULTIPLE_BUFFERS > 0)
 /**
- * @brief Returns available bytes in indicated UART buffer
- * @param uartBuffer Reference to UART buffer 
- * @return size_t Available bytes in UART buffer
+ * @brief Serial transmission (TX-empty) interrupt handler. Sends one queued byte, or disables the
+ * TX-empty interrupt when TX buffer is empty
+ * 
+ * @param uartBuffer Reference to UART buffer (parameter only present with UART_MULTIPLE_BUFFERS)
  */
-size_t uart_dataAvailable(UARTBuffer *uartBuffer); 
-#else
+void uart_txInterruptHandler(UART_BUFFER_ONLY);
+
 /**
  * @brief Returns available bytes in indicated UART buffer
+ * @param uartBuffer Reference to UART buffer (parameter only present with UART_MULTIPLE_BUFFERS)
  * @return size_t Available bytes in UART buffer
  */
-size_t uart_dataAvailable(void); 
+#if !(defined(UART_BUFFER_INLINE) && (UART_BUFFER_INLINE > 0))
+size_t uart_dataAvailable(UART_BUFFER_ONLY);
 #endif
 
-#if defined(UART_MULTIPLE_BUFFERS) && (UART_MULTIPLE_BUFFERS > 0)
 /**
  * @brief Reads the first byte from the UART buffer and "removes" it from the FIFO
- * @param uartBuffer Reference to UART buffer 
+ * @param uartBuffer Reference to UART buffer (parameter only present with UART_MULTIPLE_BUFFERS)
  * @param byte Reference to store read byte
  */
-void uart_readByteBuffer(UARTBuffer *uartBuffer, uint8_t *byte);
-#else
+void uart_readByteBuffer(UART_BUFFER_PARAM uint8_t *byte);
+
 /**
- * @brief Reads the first byte from the UART buffer and "removes" it from the FIFO
+ * @brief Reads the first byte from the UART buffer and removes it from the FIFO, reporting whether there was one.
+ * Overruns, backpressure resume and RX CRC are handled by falling back to uart_readByteBuffer
+ * @param uartBuffer Reference to UART buffer (parameter only present with UART_MULTIPLE_BUFFERS)
  * @param byte Reference to store read byte
+ * @return true Byte read
+ * @return false UART buffer empty
  */
-void uart_readByteBuffer(uint8_t *byte);
+#if !(defined(UART_BUFFER_INLINE) && (UART_BUFFER_INLINE > 0))
+bool uart_popByte(UART_BUFFER_PARAM uint8_t *byte);
 #endif
 
-#if defined(UART_MULTIPLE_BUFFERS) && (UART_MULTIPLE_BUFFERS > 0)
 /**
  * @brief Reads the first byte from the UART buffer as a query only (doesn't modify UART buffer indexes)
- * @param uartBuffer Reference to UART buffer 
+ * @param uartBuffer Reference to UART buffer (parameter only present with UART_MULTIPLE_BUFFERS)
  * @param data Reference to store read byte
  * @return UART_rxQueue_Status 
  */
-UART_rxQueue_Status uart_firstByteReceived(UARTBuffer *uartBuffer, uint8_t *byte);
-#else
-/**Reads the first byte from the UART buffer as a query only (doesn't modify UART buffer indexes) 
- * @brief 
- * @param byte Reference to store read byte
- * @return UART_rxQueue_Status 
- */
-UART_rxQueue_Status uart_firstByteReceived(uint8_t *byte);
+#if !(defined(UART_BUFFER_INLINE) && (UART_BUFFER_INLINE > 0))
+UART_rxQueue_Status uart_firstByteReceived(UART_BUFFER_PARAM uint8_t *byte);
 #endif
 
-#if defined(UART_MULTIPLE_BUFFERS) && (UART_MULTIPLE_BUFFERS > 0)
 /**
  * @brief Reads the last byte from the UART buffer as a query only (doesn't modify UART buffer indexes) 
- * @param uartBuffer Reference to UART buffer 
+ * @param uartBuffer Reference to UART buffer (parameter only present with UART_MULTIPLE_BUFFERS)
  * @param byte Reference to store read byte 
  * @return UART_rxQueue_Status 
  */
-UART_rxQueue_Status uart_lastByteReceived(UARTBuffer *uartBuffer, uint8_t *byte );
-#else
+#if !(defined(UART_BUFFER_INLINE) && (UART_BUFFER_INLINE > 0))
+UART_rxQueue_Status uart_lastByteReceived(UART_BUFFER_PARAM uint8_t *byte );
+#endif
+
 /**
- * @brief Reads the last byte from the UART buffer as a query only (doesn't modify UART buffer indexes) 
- * @param byte Reference to store read byte
- * @return UART_rxQueue_Status 
+ * @brief Reads up to 'len' bytes from UART buffer without waiting. Data is copied in at most two blocks
+ * @param uartBuffer Reference to UART buffer (parameter only present with UART_MULTIPLE_BUFFERS)
+ * @param buffer Reference to buffer that will store data read
+ * @param len Max byte quantity to read
+ * @return size_t Byte quantity actually read (0 if UART buffer is empty)
  */
-UART_rxQueue_Status uart_lastByteReceived(uint8_t *byte );
-#endif
+size_t uart_readAvailable(UART_BUFFER_PARAM uint8_t *buffer, size_t len);
 
-#if defined(UART_MULTIPLE_BUFFERS) && (UART_MULTIPLE_BUFFERS > 0)
 /**
  * @brief Reads 'len' bytes from UART buffer
- * @param uartBuffer Reference to UART buffer 
+ * @param uartBuffer Reference to UART buffer (parameter only present with UART_MULTIPLE_BUFFERS)
  * @param buffer Reference to buffer that will store data read
  * @param len Byte quantity to read
  */
-void uart_readBuffer(UARTBuffer *uartBuffer, uint8_t *buffer,size_t len);
-#else
+void uart_readBuffer(UART_BUFFER_PARAM uint8_t *buffer,size_t len);
+
 /**
- * @brief Reads 'len' bytes from UART buffer
+ * @brief Reads 'len' bytes from UART buffer, giving up after 'timeout' microseconds
+ * @param uartBuffer Reference to UART buffer (parameter only present with UART_MULTIPLE_BUFFERS)
  * @param buffer Reference to buffer that will store data read
  * @param len Byte quantity to read
+ * @param timeout Timeout in microseconds, or UART_WAIT_FOREVER
+ * @return size_t Byte quantity actually read (less than len on timeout)
  */
-void uart_readBuffer(uint8_t *buffer,size_t len);
-#endif
+size_t uart_readBufferTimeout(UART_BUFFER_PARAM uint8_t *buffer, size_t len, uint32_t timeout);
 
-#if defined(UART_MULTIPLE_BUFFERS) && (UART_MULTIPLE_BUFFERS > 0)
 /**
- * @brief Flush UART buffer, resetting indexes
- * @param uartBuffer Reference to UART buffer 
+ * @brief Exposes readable data in place as up to two spans (second one is empty unless data wraps around).
+ * Nothing is removed from UART buffer until uart_consume is called. Under overwrite policy the handler may
+ * rewrite the spans if it laps the reader before uart_consume; use copying reads when that can happen
+ * @param uartBuffer Reference to UART buffer (parameter only present with UART_MULTIPLE_BUFFERS)
+ * @param spans Array of two spans to be filled
+ * @return size_t Total readable bytes (spans[0].len + spans[1].len)
  */
-void uart_flushBuffer(UARTBuffer *uartBuffer); 
-#else
+size_t uart_peek(UART_BUFFER_PARAM UARTSpan spans[2]);
+
+/**
+ * @brief Removes 'len' bytes from UART buffer (usually after parsing them through uart_peek)
+ * @param uartBuffer Reference to UART buffer (parameter only present with UART_MULTIPLE_BUFFERS)
+ * @param len Byte quantity to remove. Limited to available bytes
+ */
+void uart_consume(UART_BUFFER_PARAM size_t len);
+
+/**
+ * @brief Exposes free space of UART buffer as up to two spans, so a DMA engine or a bulk reader can
+ * write received data in place. Data becomes readable once uart_rxCommit is called
+ * @param uartBuffer Reference to UART buffer (parameter only present with UART_MULTIPLE_BUFFERS)
+ * @param spans Array of two spans to be filled
+ * @return size_t Total writable bytes (spans[0].len + spans[1].len)
+ */
+size_t uart_rxReserve(UART_BUFFER_PARAM UARTSpan spans[2]);
+
+/**
+ * @brief Publishes 'len' bytes written through uart_rxReserve spans. Must be called from the producer
+ * context (same as uart_interruptHandler)
+ * @param uartBuffer Reference to UART buffer (parameter only present with UART_MULTIPLE_BUFFERS)
+ * @param len Byte quantity written
+ */
+void uart_rxCommit(UART_BUFFER_PARAM size_t len);
+
+/**
+ * @brief Exposes queued TX data as up to two spans, so a DMA engine or a host backend can send it in
+ * bulk instead of byte by byte through uart_txInterruptHandler
+ * @param uartBuffer Reference to UART buffer (parameter only present with UART_MULTIPLE_BUFFERS)
+ * @param spans Array of two spans to be filled
+ * @return size_t Total pending bytes (spans[0].len + spans[1].len)
+ */
+size_t uart_txPeek(UART_BUFFER_PARAM UARTSpan spans[2]);
+
+/**
+ * @brief Releases 'len' bytes sent from uart_txPeek spans. Must be called from the TX drain context
+ * (same as uart_txInterruptHandler)
+ * @param uartBuffer Reference to UART buffer (parameter only present with UART_MULTIPLE_BUFFERS)
+ * @param len Byte quantity sent. Limited to pending bytes
+ */
+void uart_txConsume(UART_BUFFER_PARAM size_t len);
+
 /**
  * @brief Flush UART buffer, resetting indexes
+ * @param uartBuffer Reference to UART buffer (parameter only present with UART_MULTIPLE_BUFFERS)
  */
-void uart_flushBuffer(void);
-#endif
+void uart_flushBuffer(UART_BUFFER_ONLY);
 
 
-#if defined(UART_MULTIPLE_BUFFERS) && (UART_MULTIPLE_BUFFERS > 0)
 /**
  * @brief Flush UART buffer, resetting indexes and discarding all data stored
- * @param uartBuffer Reference to UART buffer 
+ * @param uartBuffer Reference to UART buffer (parameter only present with UART_MULTIPLE_BUFFERS)
  */
-void uart_hardFlushBuffer(UARTBuffer *uartBuffer); 
-#else
+void uart_hardFlushBuffer(UART_BUFFER_ONLY);
+
+#if defined(UART_BUFFER_CAPTURE) && (UART_BUFFER_CAPTURE > 0)
 /**
- * @brief Flush UART buffer, resetting indexes and discarding all data stored
+ * @brief Attaches a traffic capture to UART buffer, recording received bytes from the reception handlers
+ * @param uartBuffer Reference to UART buffer (parameter only present with UART_MULTIPLE_BUFFERS)
+ * @param capture Reference to initialized capture (NULL to stop capturing)
+ */
+void uart_setCapture(UART_BUFFER_PARAM struct _UARTCapture *capture);
+#endif
+
+#if defined(UART_BUFFER_TIMESTAMP) && (UART_BUFFER_TIMESTAMP > 0)
+/**
+ * @brief Enables timestamped reception: handlers store the arrival time of every received byte in a
+ * parallel array. Burst and DMA (uart_rxCommit) reception stamp the whole chunk with its publication time
+ * @param uartBuffer Reference to UART buffer (parameter only present with UART_MULTIPLE_BUFFERS)
+ * @param stamps Reference to array of RX ring size entries (NULL to stop stamping)
+ * @param timeNow_callback Reference to microsecond clock function, called from interrupt context
+ */
+void uart_setRxTimestamps(UART_BUFFER_PARAM uint32_t *stamps, uint32_t (*timeNow_callback)(void));
+
+/**
+ * @brief Arrival time of a received byte that hasn't been read yet
+ * @param uartBuffer Reference to UART buffer (parameter only present with UART_MULTIPLE_BUFFERS)
+ * @param offset Byte position from the oldest unread byte (0 to uart_dataAvailable() - 1)
+ * @return uint32_t Arrival time in microseconds
+ */
+uint32_t uart_rxTimestamp(UART_BUFFER_PARAM size_t offset);
+#endif
+
+#if defined(UART_BUFFER_READY) && (UART_BUFFER_READY > 0)
+/**
+ * @brief Readiness set initialization
+ * @param set Reference to readiness set
+ * @param timeNow_callback Reference to microsecond clock function (NULL: only zero and UART_WAIT_FOREVER timeouts)
+ * @param wait_callback Reference to wait function (NULL: uart_waitAny spins)
+ * @param wake_callback Reference to wake function, called from interrupt context (can be NULL)
+ * @param context User data passed to wait/wake callbacks
+ */
+void uart_readyInit(UARTReadySet *set, uint32_t (*timeNow_callback)(void), void (*wait_callback)(void *context, uint32_t timeout), void (*wake_callback)(void *context), void *context);
+
+/**
+ * @brief Adds UART buffer to a readiness set as 'port', or removes it (set NULL). Current levels are
+ * evaluated right away
+ * @param uartBuffer Reference to UART buffer (parameter only present with UART_MULTIPLE_BUFFERS)
+ * @param set Reference to readiness set (NULL to remove UART buffer from its set)
+ * @param port Port index in set (0 to UART_READY_MAX_PORTS - 1)
+ * @param rxThreshold RX fill level (bytes, at least 1) reported as ready to read
+ * @param txThreshold TX ring free space (bytes) reported as ready to write, 0 to not watch TX
+ * @param delimiter Byte reported once per arrival (e.g. '\n'), or UART_READY_NO_DELIMITER
+ * @return true UART buffer added
+ * @return false Invalid port index
+ */
+bool uart_setReadySet(UART_BUFFER_PARAM UARTReadySet *set, uint8_t port, size_t rxThreshold, size_t txThreshold, int delimiter);
+
+/**
+ * @brief Waits until any port of the set is ready or timeout expires. Work is proportional to ready ports
+ * @param set Reference to readiness set
+ * @param events Reference to store ready ports by event type
+ * @param timeout Timeout in microseconds (0 to poll, UART_WAIT_FOREVER to wait forever)
+ * @return uint32_t Ready ports (events->rx | events->tx | events->delimiter), 0 on timeout
+ */
+uint32_t uart_waitAny(UARTReadySet *set, UARTReadyEvents *events, uint32_t timeout);
+#endif
+
+#if defined(UART_BUFFER_EVENTS) && (UART_BUFFER_EVENTS > 0)
+/**
+ * @brief Registers a callback fired by the reception handlers when the fill level crosses 'threshold',
+ * when 'delimiter' arrives or when uart_idleInterruptHandler reports an idle line after new data. With a
+ * defer hook the handlers only accumulate the events and call defer (once until dispatched), and the
+ * callback runs from uart_dispatchRxEvents in task context
+ * @param uartBuffer Reference to UART buffer (parameter only present with UART_MULTIPLE_BUFFERS)
+ * @param threshold Fill level (bytes) reported when reached from below, 0 to not watch it
+ * @param delimiter Byte reported on every arrival (e.g. '\n'), or UART_RX_EVENT_NO_DELIMITER
+ * @param event_callback Reference to event function, receiving context and UART_RxEvent flags (NULL to disable events)
+ * @param defer_callback Reference to function scheduling uart_dispatchRxEvents (RTOS deferred call, task
+ * notification...), called from interrupt context. NULL to run event_callback from the handlers
+ * @param context User data passed to event/defer callbacks
+ */
+void uart_setRxEvents(UART_BUFFER_PARAM size_t threshold, int delimiter, void (*event_callback)(void *context, uint8_t events), void (*defer_callback)(void *context), void *context);
+
+/**
+ * @brief Line idle interrupt handler (e.g. UART IDLE flag or an inter-byte timer), reports
+ * UART_RX_EVENT_IDLE if data was received since the previous idle event
+ * @param uartBuffer Reference to UART buffer (parameter only present with UART_MULTIPLE_BUFFERS)
+ */
+void uart_idleInterruptHandler(UART_BUFFER_ONLY);
+
+/**
+ * @brief Runs the event callback with the events accumulated by the handlers in deferred mode
+ * @param uartBuffer Reference to UART buffer (parameter only present with UART_MULTIPLE_BUFFERS)
+ * @return uint8_t Dispatched UART_RxEvent flags (0 if none pending)
  */
-void uart_hardFlushBuffer(void);
+uint8_t uart_dispatchRxEvents(UART_BUFFER_ONLY);
+#endif
+
+#if defined(UART_BUFFER_STATS) && (UART_BUFFER_STATS > 0)
+/**
+ * @brief Copies UART buffer statistics, optionally resetting them
+ * @param uartBuffer Reference to UART buffer (parameter only present with UART_MULTIPLE_BUFFERS)
+ * @param stats Reference to store statistics snapshot (NULL to just reset)
+ * @param reset Set counters to zero after copying them
+ */
+void uart_getStats(UART_BUFFER_PARAM UARTStats *stats, bool reset);
 #endif
 
 #if defined(UART_BUFFER_LOG) && (UART_BUFFER_LOG > 0)
-#if defined(UART_MULTIPLE_BUFFERS) && (UART_MULTIPLE_BUFFERS > 0)
 /**
- * @brief Dumps UART buffer content through std output
- * @param uartBuffer Reference to UART buffer 
+ * @brief Attaches an event trace to UART buffer. Several UART buffers can share one trace
+ * @param uartBuffer Reference to UART buffer (parameter only present with UART_MULTIPLE_BUFFERS)
+ * @param trace Reference to initialized trace (NULL to stop tracing)
+ * @param port Port number stored in this UART buffer's records
  */
-void uart_printBuffer(UARTBuffer *uartBuffer);
-#else
+void uart_setTrace(UART_BUFFER_PARAM struct _UARTTrace *trace, uint8_t port);
+
 /**
- * @brief Dumps UART buffer content through std output
+ * @brief Dumps unread UART buffer content through std output as a hex dump, 16 bytes per line (one
+ * output call per line), with offsets as wide as uart_index_t. Nothing is removed from UART buffer
+ * @param uartBuffer Reference to UART buffer (parameter only present with UART_MULTIPLE_BUFFERS)
+ */
+void uart_printBuffer(UART_BUFFER_ONLY);
+#endif
+
+#pragma endregion
+
+/*
+ * Whether per-byte reads must take the full path (uart_readByteBuffer fast path, uart_popByte)
  */
-void uart_printBuffer(void);
+#if defined(UART_BUFFER_LOG) && (UART_BUFFER_LOG > 0)
+#define UART_TRACE_ATTACHED(buffer) ((buffer)->trace != NULL)
+#else
+#define UART_TRACE_ATTACHED(buffer) false
+#endif
+
+#if defined(UART_BUFFER_CRC) && (UART_BUFFER_CRC > 0)
+#define UART_CRC_ATTACHED(buffer) ((buffer)->rxCrc != NULL)
+#else
+#define UART_CRC_ATTACHED(buffer) false
+#endif
+
+#if defined(UART_BUFFER_INLINE) && (UART_BUFFER_INLINE > 0)
+#pragma region Inline fast path
+/*
+ * Hot queries used in polling loops. They only read the indexes (the overrun clamp is applied to the
+ * returned values, rxTail is left to the next consuming call), so no call or stores are involved.
+ */
+
+static inline size_t uart_dataAvailable(UART_BUFFER_ONLY)
+{
+    return uart_rxUsed(UART_BUFFER_SELF);
+}
+
+static inline UART_rxQueue_Status uart_firstByteReceived(UART_BUFFER_PARAM uint8_t *byte)
+{
+    uart_index_t head = UART_LOAD_ACQUIRE(UART_BUFFER_SELF->rxHead);
+    uart_index_t used = (uart_index_t)(head - UART_BUFFER_SELF->rxTail);
+    if (used == 0)
+        return UART_RX_QUEUE_EMPTY;
+    used = (used > UART_BUFFER_SELF->rxSize) ? UART_BUFFER_SELF->rxSize : used;
+    *byte = UART_BUFFER_SELF->rxBuffer[(uart_index_t)(head - used) & UART_BUFFER_SELF->rxMask];
+    return UART_RX_QUEUE_STATUS_OK;
+}
+
+static inline UART_rxQueue_Status uart_lastByteReceived(UART_BUFFER_PARAM uint8_t *byte)
+{
+    uart_index_t head = UART_LOAD_ACQUIRE(UART_BUFFER_SELF->rxHead);
+    if (head == UART_BUFFER_SELF->rxTail)
+        return UART_RX_QUEUE_EMPTY;
+    *byte = UART_BUFFER_SELF->rxBuffer[(uart_index_t)(head - 1) & UART_BUFFER_SELF->rxMask];
+    return UART_RX_QUEUE_STATUS_OK;
+}
+
+static inline bool uart_popByte(UART_BUFFER_PARAM uint8_t *byte)
+{
+    uart_index_t tail = UART_BUFFER_SELF->rxTail;
+    uart_index_t used = (uart_index_t)(UART_LOAD_ACQUIRE(UART_BUFFER_SELF->rxHead) - tail);
+    if (used == 0)
+        return false;
+    if ((used > UART_BUFFER_SELF->rxSize) | UART_BUFFER_SELF->flowStopped | UART_CRC_ATTACHED(UART_BUFFER_SELF) | UART_TRACE_ATTACHED(UART_BUFFER_SELF))
+    {
+        uart_readByteBuffer(UART_BUFFER_ARG(UART_BUFFER_SELF) byte);
+        return true;
+    }
+    *byte = UART_BUFFER_SELF->rxBuffer[tail & UART_BUFFER_SELF->rxMask];
+    if (uart_rxLapped(UART_BUFFER_SELF, tail, 1) != 0)
+    {
+        uart_readByteBuffer(UART_BUFFER_ARG(UART_BUFFER_SELF) byte);   // Overwritten while read
+        return true;
+    }
+    UART_STORE_RELEASE(UART_BUFFER_SELF->rxTail, (uart_index_t)(tail + 1));
+    return true;
+}
+
+#pragma endregion
 #endif
+
+#pragma region Port specialization
+/*
+ * Compile-time port specialization. Ports are listed once in an X-macro with constant ring sizes and
+ * the hardware accessors bound by name:
+ *
+ *     #define UART_PORTS(X) \
+ *         X(gps,   256, 64, 9600,   gps_readByte, gps_writeByte, gps_txEnable) \
+ *         X(modem, 1024, 256, 115200, modem_readByte, modem_writeByte, modem_txEnable)
+ *
+ *     UART_PORTS(UART_PORT_DECLARE)    // in a header
+ *     UART_PORTS(UART_PORT_DEFINE)     // in exactly one source file
+ *
+ * For every port this yields a statically initialized UARTBuffer (usable right away with the pointer API,
+ * UART_MULTIPLE_BUFFERS builds) plus inline functions <name>_interruptHandler, <name>_txInterruptHandler,
+ * <name>_dataAvailable, <name>_readByte and <name>_writeByte. These work on the port storage with constant
+ * masks and call the accessors directly, so the compiler inlines the whole path into the ISR or polling
+ * loop. Sizes must be powers of two. The specialized handlers implement the overwrite policy only and skip
+ * wait hooks, CRC, statistics and capture; both APIs may be mixed on the same port as long as each ring
+ * side (producer/consumer) sticks to one of them.
+ *
+ * With UART_BUFFER_STATIC_STORAGE the rings live in the storage embedded in the port UARTBuffer, so port
+ * sizes can't exceed UART_RX_BUFFER_SIZE/UART_TX_BUFFER_SIZE (smaller ports leave the rest unused). Builds
+ * whose buffers are all ports should set UART_BUFFER_STATIC_STORAGE to zero: every port then gets arrays
+ * <name>_rxStorage and <name>_txStorage of its exact sizes.
+ */
+
+#if defined(UART_BUFFER_STATIC_STORAGE) && (UART_BUFFER_STATIC_STORAGE > 0)
+#define UART_PORT_RX_STORAGE(NAME)  NAME.rxStorage
+#define UART_PORT_TX_STORAGE(NAME)  NAME.txStorage
+#define UART_PORT_STORAGE_DECLARE(NAME, RX_SIZE, TX_SIZE)
+#define UART_PORT_STORAGE_DEFINE(NAME, RX_SIZE, TX_SIZE) \
+    typedef char NAME##_portStorageCheck[((RX_SIZE) <= UART_RX_BUFFER_SIZE && (TX_SIZE) <= UART_TX_BUFFER_SIZE) ? 1 : -1];
+#else
+#define UART_PORT_RX_STORAGE(NAME)  NAME##_rxStorage
+#define UART_PORT_TX_STORAGE(NAME)  NAME##_txStorage
+#define UART_PORT_STORAGE_DECLARE(NAME, RX_SIZE, TX_SIZE) \
+    extern uint8_t NAME##_rxStorage[RX_SIZE]; \
+    extern uint8_t NAME##_txStorage[TX_SIZE];
+#define UART_PORT_STORAGE_DEFINE(NAME, RX_SIZE, TX_SIZE) \
+    uint8_t NAME##_rxStorage[RX_SIZE]; \
+    uint8_t NAME##_txStorage[TX_SIZE];
 #endif
 
+/**
+ * @brief Declares port NAME and its specialized functions
+ */
+#define UART_PORT_DECLARE(NAME, RX_SIZE, TX_SIZE, BAUD, HW_READ, HW_WRITE, HW_TX_ENABLE) \
+    extern UARTBuffer NAME; \
+    UART_PORT_STORAGE_DECLARE(NAME, RX_SIZE, TX_SIZE) \
+    static inline void NAME##_interruptHandler(void) \
+    { \
+        uart_index_t head = NAME.rxHead; \
+        UART_STORE_RELEASE(NAME.rxClaim, (uart_index_t)(head + 1)); \
+        UART_FENCE_RELEASE(); \
+        UART_PORT_RX_STORAGE(NAME)[head & ((RX_SIZE) - 1)] = HW_READ(); \
+        UART_STORE_RELEASE(NAME.rxHead, (uart_index_t)(head + 1)); \
+    } \
+    static inline void NAME##_txInterruptHandler(void) \
+    { \
+        uart_index_t tail = NAME.txTail; \
+        if (UART_LOAD_ACQUIRE(NAME.txHead) == tail) \
+        { \
+            HW_TX_ENABLE(false); \
+            if (UART_LOAD_ACQUIRE(NAME.txHead) != tail) \
+                HW_TX_ENABLE(true); \
+            return; \
+        } \
+        HW_WRITE(UART_PORT_TX_STORAGE(NAME)[tail & ((TX_SIZE) - 1)]); \
+        UART_STORE_RELEASE(NAME.txTail, (uart_index_t)(tail + 1)); \
+    } \
+    static inline size_t NAME##_dataAvailable(void) \
+    { \
+        uart_index_t used = (uart_index_t)(UART_LOAD_ACQUIRE(NAME.rxHead) - UART_LOAD_ACQUIRE(NAME.rxTail)); \
+        return (used > (RX_SIZE)) ? (RX_SIZE) : used; \
+    } \
+    static inline bool NAME##_readByteLapped(uint8_t *byte) \
+    { \
+        uart_index_t tail; \
+        do \
+        { \
+            uart_index_t head = UART_LOAD_ACQUIRE(NAME.rxHead); \
+            tail = NAME.rxTail; \
+            if (head == tail) \
+                return false; \
+            if ((uart_index_t)(head - tail) > (RX_SIZE)) \
+                tail = (uart_index_t)(head - (RX_SIZE));    /* Lapped by the producer, oldest bytes are lost */ \
+            *byte = UART_PORT_RX_STORAGE(NAME)[tail & ((RX_SIZE) - 1)]; \
+            UART_STORE_RELEASE(NAME.rxTail, (uart_index_t)(tail + 1)); \
+            UART_FENCE_ACQUIRE(); \
+        } while ((uart_index_t)(UART_LOAD_ACQUIRE(NAME.rxClaim) - tail) > (RX_SIZE));   /* Overwritten while read */ \
+        return true; \
+    } \
+    static inline bool NAME##_readByte(uint8_t *byte) \
+    { \
+        uart_index_t tail = NAME.rxTail; \
+        if (UART_LOAD_ACQUIRE(NAME.rxHead) == tail) \
+            return false; \
+        *byte = UART_PORT_RX_STORAGE(NAME)[tail & ((RX_SIZE) - 1)]; \
+        UART_FENCE_ACQUIRE(); \
+        /* Claim past tail + RX_SIZE: lapped before or while reading, the lapped path drops the lost bytes */ \
+        if ((uart_index_t)(UART_LOAD_ACQUIRE(NAME.rxClaim) - tail) > (RX_SIZE)) \
+            return NAME##_readByteLapped(byte); \
+        UART_STORE_RELEASE(NAME.rxTail, (uart_index_t)(tail + 1)); \
+        return true; \
+    } \
+    static inline bool NAME##_writeByte(uint8_t byte) \
+    { \
+        uart_index_t head = NAME.txHead; \
+        if ((uart_index_t)(head - UART_LOAD_ACQUIRE(NAME.txTail)) >= (TX_SIZE)) \
+            return false; \
+        UART_PORT_TX_STORAGE(NAME)[head & ((TX_SIZE) - 1)] = byte; \
+        UART_STORE_RELEASE(NAME.txHead, (uart_index_t)(head + 1)); \
+        HW_TX_ENABLE(true); \
+        return true; \
+    }
+
+/**
+ * @brief Defines port NAME (and its storage arrays without UART_BUFFER_STATIC_STORAGE), initialized as
+ * uart_buffer_initStorage followed by uart_txInit would
+ */
+#define UART_PORT_DEFINE(NAME, RX_SIZE, TX_SIZE, BAUD, HW_READ, HW_WRITE, HW_TX_ENABLE) \
+    typedef char NAME##_portSizeCheck[((RX_SIZE) >= 2 && (RX_SIZE) <= UART_MAX_CAPACITY && ((RX_SIZE) & ((RX_SIZE) - 1)) == 0 && \
+                                       (TX_SIZE) >= 2 && (TX_SIZE) <= UART_MAX_CAPACITY && ((TX_SIZE) & ((TX_SIZE) - 1)) == 0) ? 1 : -1]; \
+    UART_PORT_STORAGE_DEFINE(NAME, RX_SIZE, TX_SIZE) \
+    UARTBuffer NAME = { \
+        .rxBuffer = UART_PORT_RX_STORAGE(NAME), \
+        .rxSize = (uart_index_t)(RX_SIZE), \
+        .rxMask = (uart_index_t)((RX_SIZE) - 1), \
+        .txBuffer = UART_PORT_TX_STORAGE(NAME), \
+        .txSize = (uart_index_t)(TX_SIZE), \
+        .txMask = (uart_index_t)((TX_SIZE) - 1), \
+        .baudRate = (BAUD), \
+        .writeByte = HW_WRITE, \
+        .readByte = HW_READ, \
+        .txInterruptEnable = HW_TX_ENABLE, \
+        .overflowPolicy = UART_OVERFLOW_OVERWRITE, \
+        .highWatermark = (RX_SIZE), \
+    };
+
 #pragma endregion
 
 #ifdef __cplusplus
@@ -0,0 +1,161 @@
+/**
+ * @file uart_capture.c
+ * @author Roberto Parra (uedsoldier1990@gmail.com)
+ * @brief
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#if defined(__unix__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
+#include <string.h>
+#include "uart_capture.h"
+
+bool uart_captureInit(UARTCapture *capture, uint8_t *log, size_t size, uint32_t (*timeNow_callback)(void))
+{
+    if (size < UART_CAPTURE_HEADER)
+        return false;
+    memcpy(log, UART_CAPTURE_MAGIC, UART_CAPTURE_HEADER);
+    capture->log = log;
+    capture->size = size;
+    capture->len = UART_CAPTURE_HEADER;
+    capture->timeNow = timeNow_callback;
+    capture->last = 0;
+    capture->started = false;
+    capture->lost = 0;
+    return true;
+}
+
+void uart_captureRecord(UARTCapture *capture, const uint8_t *data, size_t len)
+{
+    uint32_t now = capture->timeNow();
+    uint32_t delta = capture->started ? now - capture->last : 0;
+    capture->last = now;
+    capture->started = true;
+
+    for (size_t i = 0; i != len; i++)
+    {
+        uint8_t record[6];
+        size_t count = 0;
+        do
+        {
+            record[count++] = (uint8_t)((delta & 0x7F) | (delta > 0x7F ? 0x80 : 0x00));
+            delta >>= 7;
+        } while (delta != 0);
+        record[count++] = data[i];
+
+        if (count > capture->size - capture->len)
+        {
+            capture->lost += (uint32_t)(len - i);
+            return;
+        }
+        memcpy(capture->log + capture->len, record, count);
+        capture->len += count;
+        delta = 0;      // Remaining bytes of this call share its timestamp
+    }
+}
+
+#if defined(__unix__)
+#include <sched.h>
+#include <time.h>
+
+#if defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 201112L)
+#define UART_REPLAY_THREAD_LOCAL _Thread_local
+#else
+#define UART_REPLAY_THREAD_LOCAL __thread
+#endif
+
+/**
+ * @brief Replay being run by the calling thread, source of uart_replayReadByte data. readByte callbacks
+ * take no context, but uart_replayRun calls the interrupt handler from its own thread, so one replay per
+ * thread can run at a time
+ */
+static UART_REPLAY_THREAD_LOCAL UARTReplay *uart_replayActive;
+
+/**
+ * @brief Decodes next record
+ * @return true Record decoded into delta and replay->next
+ * @return false End of log (or truncated record)
+ */
+static bool uart_replayNext(UARTReplay *replay, uint32_t *delta)
+{
+    uint32_t value = 0;
+    unsigned shift = 0;
+    while (replay->pos != replay->len && shift < 35)
+    {
+        uint8_t byte = replay->log[replay->pos++];
+        value |= (uint32_t)(byte & 0x7F) << shift;
+        shift += 7;
+        if ((byte & 0x80) == 0)
+        {
+            if (replay->pos == replay->len)
+                return false;
+            replay->next = replay->log[replay->pos++];
+            *delta = value;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool uart_replayInit(UARTReplay *replay, UART_BUFFER_PARAM const uint8_t *log, size_t len, bool lossless)
+{
+    if (len < UART_CAPTURE_HEADER || memcmp(log, UART_CAPTURE_MAGIC, UART_CAPTURE_HEADER) != 0)
+        return false;
+#if defined(UART_MULTIPLE_BUFFERS) && (UART_MULTIPLE_BUFFERS > 0)
+    replay->buffer = uartBuffer;
+#endif
+    replay->log = log;
+    replay->len = len;
+    replay->pos = UART_CAPTURE_HEADER;
+    replay->next = 0;
+    replay->lossless = lossless;
+    return true;
+}
+
+uint8_t uart_replayReadByte(void)
+{
+    return uart_replayActive->next;
+}
+
+size_t uart_replayRun(UARTReplay *replay, double speed)
+{
+    struct timespec deadline;
+    uint32_t delta;
+    double offset = 0;      // Scaled time since first byte, in nanoseconds
+    size_t count = 0;
+
+    uart_replayActive = replay;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    time_t baseSec = deadline.tv_sec;
+    long baseNsec = deadline.tv_nsec;
+
+    while (uart_replayNext(replay, &delta))
+    {
+        if (speed > 0 && delta != 0)
+        {
+            offset += (double)delta * 1000.0 / speed;
+            long long nsec = (long long)baseNsec + (long long)offset;
+            deadline.tv_sec = baseSec + (time_t)(nsec / 1000000000LL);
+            deadline.tv_nsec = (long)(nsec % 1000000000LL);
+            while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL) != 0){}
+        }
+        if (replay->lossless)
+        {
+            UARTSpan spans[2];
+            while (uart_rxReserve(UART_BUFFER_ARG(replay->buffer) spans) == 0)
+            {
+                sched_yield();
+            }
+        }
+        uart_interruptHandler(UART_BUFFER_REF(replay->buffer));
+        count++;
+    }
+    return count;
+}
+#endif
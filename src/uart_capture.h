@@ -0,0 +1,127 @@
+/**
+ * @file uart_capture.h
+ * @author Roberto Parra (uedsoldier1990@gmail.com)
+ * @brief Timestamped RX traffic capture and deterministic replay through the interrupt handler
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef UART_CAPTURE_H
+#define UART_CAPTURE_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#pragma region Dependencies
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#pragma endregion
+
+/*
+ * Capture log format: 4 byte magic "UCAP", then one record per received byte: the time elapsed since
+ * the previous byte in microseconds as a LEB128 varint, followed by the byte itself. At usual baud
+ * rates a record takes 2 or 3 bytes.
+ */
+#define UART_CAPTURE_MAGIC      "UCAP"
+#define UART_CAPTURE_HEADER     4
+
+/**
+ * @brief Capture state. Records are appended to caller-owned memory from the reception handler, so
+ * recording is ISR safe and doesn't block; once storage is full further bytes are counted as lost
+ */
+typedef struct _UARTCapture{
+    uint8_t *log;               // Caller-owned log storage
+    size_t size;                // Storage size in bytes
+    size_t len;                 // Log bytes used so far
+    uint32_t (*timeNow)(void);  // Free-running microsecond clock
+    uint32_t last;              // Timestamp of previous record
+    bool started;
+    uint32_t lost;              // Bytes not recorded (storage full)
+} UARTCapture;
+
+#pragma region Function prototypes
+
+/**
+ * @brief Capture initialization. Attach it to a UART buffer with uart_setCapture (needs UART_BUFFER_CAPTURE)
+ * @param capture Reference to capture state
+ * @param log Reference to log storage
+ * @param size Log storage size in bytes
+ * @param timeNow_callback Reference to microsecond clock function
+ * @return true Capture ready
+ * @return false Storage too small for the log header
+ */
+bool uart_captureInit(UARTCapture *capture, uint8_t *log, size_t size, uint32_t (*timeNow_callback)(void));
+
+/**
+ * @brief Records received bytes, all of them stamped with current time (called from the reception handlers)
+ * @param capture Reference to capture state
+ * @param data Received bytes
+ * @param len Byte quantity
+ */
+void uart_captureRecord(UARTCapture *capture, const uint8_t *data, size_t len);
+
+#pragma endregion
+
+#if defined(__unix__)
+#pragma region Dependencies
+#include "uart_buffer.h"
+#pragma endregion
+
+/**
+ * @brief Replay state
+ */
+typedef struct _UARTReplay{
+#if defined(UART_MULTIPLE_BUFFERS) && (UART_MULTIPLE_BUFFERS > 0)
+    UARTBuffer *buffer;
+#endif
+    const uint8_t *log;
+    size_t len;
+    size_t pos;                 // Read position in log
+    uint8_t next;               // Byte returned by uart_replayReadByte
+    bool lossless;              // Wait for ring space instead of overrunning the reader
+} UARTReplay;
+
+#pragma region Function prototypes
+
+/**
+ * @brief Replay initialization. UART buffer must be initialized with uart_replayReadByte as its readByte callback
+ * @param replay Reference to replay state
+ * @param uartBuffer Reference to UART buffer the capture is fed to
+ * @param log Capture log
+ * @param len Capture log length
+ * @param lossless Wait for ring space (as a flow-controlled peer) instead of overrunning the reader
+ * @return true Replay ready
+ * @return false Invalid log header
+ */
+bool uart_replayInit(UARTReplay *replay, UART_BUFFER_PARAM const uint8_t *log, size_t len, bool lossless);
+
+/**
+ * @brief readByte callback returning the byte being replayed by the calling thread's uart_replayRun
+ * @return uint8_t Replayed byte
+ */
+uint8_t uart_replayReadByte(void);
+
+/**
+ * @brief Feeds the whole capture through uart_interruptHandler, blocking until done. Usually run in a
+ * thread playing the role of the interrupt while the application reads. Several buffers can be replayed
+ * at once, each from its own thread (the replayed byte is kept per thread)
+ * @param replay Reference to replay state
+ * @param speed Speed multiplier over original timing (1.0 original speed, 0 as fast as possible)
+ * @return size_t Replayed byte quantity (less than recorded on malformed log)
+ */
+size_t uart_replayRun(UARTReplay *replay, double speed);
+
+#pragma endregion
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*UART_CAPTURE_H*/
@@ -0,0 +1,116 @@
+/**
+ * @file uart_crc.h
+ * @author Roberto Parra (uedsoldier1990@gmail.com)
+ * @brief Incremental CRC engines (table-driven, slice-by-N) for UART buffer data
+ * @version 0.1
+ * @date 2026-10-16
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ */
+
+#ifndef UART_CRC_H
+#define UART_CRC_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#pragma region Dependencies
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#pragma endregion
+
+/**
+ * @brief Lookup tables per CRC type: 1 (classic byte-wise table) or 8 (slice-by-8, 8 bytes per step).
+ * Byte-wise tables are constant (flash); slice-by-8 tables are generated in RAM the first time a CRC type is
+ * initialized: 256 entries of 2 (CRC-16) or 4 (CRC-32) bytes per slice, about 16 KB for all three types
+ */
+#ifndef UART_CRC_SLICES
+#define UART_CRC_SLICES 1
+#endif
+
+#if (UART_CRC_SLICES != 1) && (UART_CRC_SLICES != 8)
+#error "UART_CRC_SLICES must be 1 or 8"
+#endif
+
+typedef enum _UART_CrcType{
+    UART_CRC16_CCITT = 0,   // CRC-16/CCITT-FALSE: poly 0x1021, init 0xFFFF, not reflected
+    UART_CRC16_MODBUS,      // CRC-16/MODBUS: poly 0x8005 (reflected 0xA001), init 0xFFFF
+    UART_CRC32,             // CRC-32 (IEEE 802.3): poly 0x04C11DB7 (reflected 0xEDB88320), init and final XOR 0xFFFFFFFF
+    UART_CRC_TYPE_MAX
+} UART_CrcType;
+
+/**
+ * @brief Running CRC state
+ */
+typedef struct _UARTCrc{
+    UART_CrcType type;
+    uint32_t value;     // Current register value (final XOR not applied)
+    uint32_t (*hardware)(UART_CrcType type, uint32_t crc, const uint8_t *data, size_t len);
+} UARTCrc;
+
+#pragma region Function prototypes
+
+/**
+ * @brief CRC initialization. Generates lookup tables for this type if needed (slice-by-8 only)
+ * @param crc Reference to CRC state
+ * @param type CRC type
+ */
+void uart_crcInit(UARTCrc *crc, UART_CrcType type);
+
+/**
+ * @brief Restarts CRC computation (same type)
+ * @param crc Reference to CRC state
+ */
+void uart_crcReset(UARTCrc *crc);
+
+/**
+ * @brief Registers a hardware CRC unit. It receives the register value (final XOR not applied) and must return the updated one
+ * @param crc Reference to CRC state
+ * @param hardware_callback Reference to hardware CRC function, or NULL to use lookup tables
+ */
+void uart_crcSetHardware(UARTCrc *crc, uint32_t (*hardware_callback)(UART_CrcType type, uint32_t crc, const uint8_t *data, size_t len));
+
+/**
+ * @brief Updates CRC with 'len' bytes
+ * @param crc Reference to CRC state
+ * @param data Data
+ * @param len Data length
+ */
+void uart_crcUpdate(UARTCrc *crc, const uint8_t *data, size_t len);
+
+/**
+ * @brief Returns CRC of all data processed since initialization/reset
+ * @param crc Reference to CRC state
+ * @return uint32_t CRC value (final XOR applied)
+ */
+uint32_t uart_crcValue(const UARTCrc *crc);
+
+/**
+ * @brief One-shot CRC computation through lookup tables
+ * @param type CRC type
+ * @param data Data
+ * @param len Data length
+ * @return uint32_t CRC value
+ */
+uint32_t uart_crcCompute(UART_CrcType type, const uint8_t *data, size_t len);
+
+/**
+ * @brief One-shot bit-by-bit CRC computation (no tables). Reference implementation
+ * @param type CRC type
+ * @param data Data
+ * @param len Data length
+ * @return uint32_t CRC value
+ */
+uint32_t uart_crcBitwise(UART_CrcType type, const uint8_t *data, size_t len);
+
+#pragma endregion
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*UART_CRC_H*/
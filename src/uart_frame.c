@@ -0,0 +1,208 @@
+/**
+ * @file uart_frame.c
+ * @author Roberto Parra (uedsoldier1990@gmail.com)
+ * @brief
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "uart_frame.h"
+
+/**
+ * @brief Appends decoded bytes to current frame, flagging overflow if they don't fit
+ */
+static inline void uart_frameAppend(UARTFrameDecoder *decoder, const uint8_t *data, size_t len)
+{
+    if (decoder->overflow || len > decoder->size - decoder->len)
+    {
+        decoder->overflow = true;
+        return;
+    }
+    memcpy(decoder->frame + decoder->len, data, len);
+    decoder->len += len;
+}
+
+/**
+ * @brief Handles a frame delimiter. Empty, malformed and overflowed frames are discarded
+ * @return true A valid frame is complete
+ */
+static inline bool uart_frameEnd(UARTFrameDecoder *decoder, size_t *frameLen)
+{
+    bool valid = !decoder->overflow && decoder->remaining == 0 && !decoder->escape && decoder->len != 0;
+    *frameLen = valid ? decoder->len : 0;
+    decoder->len = 0;
+    decoder->remaining = 0;
+    decoder->pendingZero = false;
+    decoder->escape = false;
+    decoder->overflow = false;
+    return valid;
+}
+
+static size_t uart_cobsDecode(UARTFrameDecoder *decoder, const uint8_t *data, size_t len, size_t *frameLen)
+{
+    static const uint8_t zero = 0x00;
+    size_t i = 0;
+    while (i < len)
+    {
+        if (decoder->remaining == 0)
+        {
+            // Block code byte
+            uint8_t code = data[i++];
+            if (code == 0x00)
+            {
+                if (uart_frameEnd(decoder, frameLen))
+                    return i;
+                continue;
+            }
+            if (decoder->pendingZero)
+                uart_frameAppend(decoder, &zero, 1);
+            decoder->remaining = code - 1;
+            decoder->pendingZero = (code != 0xFF);
+            continue;
+        }
+        // Block data is copied as a whole, unless a delimiter shows up in the middle (malformed frame)
+        size_t run = (decoder->remaining < len - i) ? decoder->remaining : len - i;
+        const uint8_t *delimiter = (const uint8_t *)memchr(data + i, 0x00, run);
+        if (delimiter != NULL)
+        {
+            decoder->overflow = true;
+            i = (size_t)(delimiter - data);
+            decoder->remaining = 0;
+            continue;
+        }
+        uart_frameAppend(decoder, data + i, run);
+        decoder->remaining -= (uint8_t)run;
+        i += run;
+    }
+    return i;
+}
+
+static size_t uart_slipDecode(UARTFrameDecoder *decoder, const uint8_t *data, size_t len, size_t *frameLen)
+{
+    size_t i = 0;
+    while (i < len)
+    {
+        uint8_t byte = data[i++];
+        if (byte == UART_SLIP_END)
+        {
+            if (uart_frameEnd(decoder, frameLen))
+                return i;
+        }
+        else if (decoder->escape)
+        {
+            decoder->escape = false;
+            if (byte == UART_SLIP_ESC_END)
+                byte = UART_SLIP_END;
+            else if (byte == UART_SLIP_ESC_ESC)
+                byte = UART_SLIP_ESC;
+            uart_frameAppend(decoder, &byte, 1);
+        }
+        else if (byte == UART_SLIP_ESC)
+        {
+            decoder->escape = true;
+        }
+        else if (!decoder->overflow && decoder->len < decoder->size)
+        {
+            decoder->frame[decoder->len++] = byte;
+        }
+        else
+        {
+            decoder->overflow = true;
+        }
+    }
+    return i;
+}
+
+void uart_frameDecoderInit(UARTFrameDecoder *decoder, UART_FrameType type, uint8_t *frame, size_t size, void (*frameComplete_callback)(const uint8_t *frame, size_t len, void *context), void *context)
+{
+    decoder->type = type;
+    decoder->frame = frame;
+    decoder->size = size;
+    decoder->len = 0;
+    decoder->remaining = 0;
+    decoder->pendingZero = false;
+    decoder->escape = false;
+    decoder->overflow = false;
+    decoder->frameComplete = frameComplete_callback;
+    decoder->context = context;
+}
+
+size_t uart_frameFeed(UARTFrameDecoder *decoder, const uint8_t *data, size_t len, size_t *frameLen)
+{
+    *frameLen = 0;
+    if (decoder->type == UART_FRAME_COBS)
+        return uart_cobsDecode(decoder, data, len, frameLen);
+    return uart_slipDecode(decoder, data, len, frameLen);
+}
+
+/**
+ * @brief Feeds readable spans of UART buffer to the decoder, up to the end of the first complete frame
+ * @return size_t Encoded bytes processed (to be consumed from UART buffer)
+ */
+static size_t uart_frameFeedSpans(UARTFrameDecoder *decoder, const UARTSpan spans[2], size_t *frameLen)
+{
+    size_t processed = uart_frameFeed(decoder, spans[0].data, spans[0].len, frameLen);
+    if (*frameLen == 0 && spans[1].len != 0)
+        processed += uart_frameFeed(decoder, spans[1].data, spans[1].len, frameLen);
+    if (*frameLen != 0 && decoder->frameComplete != NULL)
+        decoder->frameComplete(decoder->frame, *frameLen, decoder->context);
+    return processed;
+}
+
+size_t uart_frameRead(UART_BUFFER_PARAM UARTFrameDecoder *decoder)
+{
+    UARTSpan spans[2];
+    size_t frameLen;
+    if (uart_peek(UART_BUFFER_ARG(uartBuffer) spans) == 0)
+        return 0;
+    uart_consume(UART_BUFFER_ARG(uartBuffer) uart_frameFeedSpans(decoder, spans, &frameLen));
+    return frameLen;
+}
+
+void uart_frameWrite(UART_BUFFER_PARAM UART_FrameType type, const uint8_t *data, size_t len)
+{
+    const uint8_t *end = data + len;
+    if (type == UART_FRAME_COBS)
+    {
+        // Every block is a code byte followed by a run of up to 254 non-zero bytes
+        while (true)
+        {
+            size_t run = (size_t)(end - data) < 254 ? (size_t)(end - data) : 254;
+            const uint8_t *zero = (const uint8_t *)memchr(data, 0x00, run);
+            uint8_t code = (zero != NULL) ? (uint8_t)(zero - data + 1) : (run == 254 ? 0xFF : (uint8_t)(run + 1));
+            size_t count = (zero != NULL) ? (size_t)(zero - data) : run;
+            uart_write(UART_BUFFER_ARG(uartBuffer) &code, 1);
+            uart_writeBuffer(UART_BUFFER_ARG(uartBuffer) (uint8_t *)data, count);
+            data += count;
+            if (zero != NULL)
+                data++;     // Zero is implied by the code byte
+            else if (count < 254 || data == end)
+                break;
+        }
+        uint8_t delimiter = 0x00;
+        uart_write(UART_BUFFER_ARG(uartBuffer) &delimiter, 1);
+    }
+    else
+    {
+        static const uint8_t escEnd[2] = {UART_SLIP_ESC, UART_SLIP_ESC_END};
+        static const uint8_t escEsc[2] = {UART_SLIP_ESC, UART_SLIP_ESC_ESC};
+        uint8_t delimiter = UART_SLIP_END;
+        uart_write(UART_BUFFER_ARG(uartBuffer) &delimiter, 1);     // Flushes any line noise at the receiver
+        while (data != end)
+        {
+            const uint8_t *run = data;
+            while (data != end && *data != UART_SLIP_END && *data != UART_SLIP_ESC)
+                data++;
+            uart_writeBuffer(UART_BUFFER_ARG(uartBuffer) (uint8_t *)run, (size_t)(data - run));
+            if (data != end)
+            {
+                uart_write(UART_BUFFER_ARG(uartBuffer) (void *)(*data == UART_SLIP_END ? escEnd : escEsc), 2);
+                data++;
+            }
+        }
+        uart_write(UART_BUFFER_ARG(uartBuffer) &delimiter, 1);
+    }
+}
@@ -0,0 +1,100 @@
+/**
+ * @file uart_frame.h
+ * @author Roberto Parra (uedsoldier1990@gmail.com)
+ * @brief Byte-stuffed framing (COBS and SLIP) on top of UART buffer
+ * @version 0.1
+ * @date 2026-10-16
+ * 
+ * @copyright Copyright (c) 2026
+ * 
+ */
+
+#ifndef UART_FRAME_H
+#define UART_FRAME_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#pragma region Dependencies
+#include "uart_buffer.h"
+#pragma endregion
+
+/**
+ * @brief SLIP special characters (RFC 1055)
+ */
+#define UART_SLIP_END     0xC0
+#define UART_SLIP_ESC     0xDB
+#define UART_SLIP_ESC_END 0xDC
+#define UART_SLIP_ESC_ESC 0xDD
+
+typedef enum _UART_FrameType{
+    UART_FRAME_COBS = 0,    // Consistent Overhead Byte Stuffing, frames delimited by 0x00
+    UART_FRAME_SLIP         // Serial Line Internet Protocol, frames delimited by 0xC0
+} UART_FrameType;
+
+/**
+ * @brief Streaming frame decoder state. Decoded data is written straight into caller-owned storage
+ */
+typedef struct _UARTFrameDecoder{
+    UART_FrameType type;
+    uint8_t *frame;         // Caller-owned storage for decoded frame
+    size_t size;            // Storage size in bytes
+    size_t len;             // Decoded bytes of current frame
+    uint8_t remaining;      // COBS: data bytes left in current block
+    bool pendingZero;       // COBS: a zero must be inserted before next block
+    bool escape;            // SLIP: previous byte was UART_SLIP_ESC
+    bool overflow;          // Current frame doesn't fit in storage and will be discarded
+    void (*frameComplete)(const uint8_t *frame, size_t len, void *context);
+    void *context;
+} UARTFrameDecoder;
+
+#pragma region Function prototypes
+
+/**
+ * @brief Frame decoder initialization
+ * @param decoder Reference to frame decoder
+ * @param type Framing type
+ * @param frame Reference to array that will store decoded frames
+ * @param size Size of frame array in bytes (max decoded frame length)
+ * @param frameComplete_callback Reference to function called for every complete frame (can be NULL)
+ * @param context User data passed to frameComplete_callback
+ */
+void uart_frameDecoderInit(UARTFrameDecoder *decoder, UART_FrameType type, uint8_t *frame, size_t size, void (*frameComplete_callback)(const uint8_t *frame, size_t len, void *context), void *context);
+
+/**
+ * @brief Decodes a chunk of encoded data, stopping right after the first complete frame
+ * @param decoder Reference to frame decoder
+ * @param data Encoded data
+ * @param len Encoded data length
+ * @param frameLen Reference to store decoded frame length (0 if no frame was completed)
+ * @return size_t Encoded bytes processed
+ */
+size_t uart_frameFeed(UARTFrameDecoder *decoder, const uint8_t *data, size_t len, size_t *frameLen);
+
+/**
+ * @brief Non-blocking frame reception. Decodes received data in place from UART buffer into the decoder
+ * storage (one pass, no intermediate copy) and removes it from UART buffer
+ * @param uartBuffer Reference to UART buffer (parameter only present with UART_MULTIPLE_BUFFERS)
+ * @param decoder Reference to frame decoder
+ * @return size_t Decoded frame length once a frame is complete (frameComplete callback is called as well), 0 otherwise
+ */
+size_t uart_frameRead(UART_BUFFER_PARAM UARTFrameDecoder *decoder);
+
+/**
+ * @brief Encodes and sends a frame through UART (TX buffer if enabled). Unstuffed runs are sent in bulk
+ * @param uartBuffer Reference to UART buffer (parameter only present with UART_MULTIPLE_BUFFERS)
+ * @param type Framing type
+ * @param data Frame data
+ * @param len Frame length
+ */
+void uart_frameWrite(UART_BUFFER_PARAM UART_FrameType type, const uint8_t *data, size_t len);
+
+#pragma endregion
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*UART_FRAME_H*/
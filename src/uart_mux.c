@@ -0,0 +1,186 @@
+/**
+ * @file uart_mux.c
+ * @author Roberto Parra (uedsoldier1990@gmail.com)
+ * @brief
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include <string.h>
+#include "uart_mux.h"
+
+/**
+ * @brief Channel TX rings only queue data for uart_muxTransmit, there is no interrupt to enable
+ */
+static void uart_muxTxEnable(bool enable)
+{
+    (void)enable;
+}
+
+/**
+ * @brief Copies 'len' bytes starting 'offset' bytes into a pair of ring spans
+ */
+static void uart_muxSpanCopy(const UARTSpan spans[2], size_t offset, uint8_t *data, size_t len)
+{
+    if (offset < spans[0].len)
+    {
+        size_t first = (spans[0].len - offset < len) ? spans[0].len - offset : len;
+        memcpy(data, spans[0].data + offset, first);
+        data += first;
+        len -= first;
+        offset = 0;
+    }
+    else
+    {
+        offset -= spans[0].len;
+    }
+    memcpy(data, spans[1].data + offset, len);
+}
+
+/**
+ * @brief Length of the next frame queued in a channel TX ring
+ * @return true A complete record is queued
+ */
+static bool uart_muxPending(UARTMuxChannel *channel, UARTSpan spans[2], size_t *len)
+{
+    uint8_t header[UART_MUX_RECORD_HEADER];
+    size_t queued = uart_txPeek(channel->buffer, spans);
+    if (queued < UART_MUX_RECORD_HEADER)
+        return false;
+    uart_muxSpanCopy(spans, 0, header, UART_MUX_RECORD_HEADER);
+    *len = (size_t)header[0] | ((size_t)header[1] << 8);
+    return queued >= UART_MUX_RECORD_HEADER + *len;
+}
+
+/**
+ * @brief Checks that the link can take an encoded frame of 'len' bytes (worst case stuffing) without waiting
+ */
+static bool uart_muxLinkFits(UARTMux *mux, size_t len)
+{
+    if (mux->link->txInterruptEnable == NULL)
+        return true;    // Synchronous link, written as it goes
+    size_t encoded = (mux->type == UART_FRAME_COBS) ? len + len / 254 + 2 : 2 * len + 2;
+    return uart_txSpace(mux->link) >= encoded;
+}
+
+/**
+ * @brief Delivers a decoded link frame to its channel RX ring, as a whole or not at all
+ */
+static bool uart_muxDeliver(UARTMux *mux, const uint8_t *frame, size_t len)
+{
+    UARTSpan spans[2];
+    if (len == 0 || frame[0] >= UART_MUX_MAX_CHANNELS || mux->channels[frame[0]].buffer == NULL)
+    {
+        mux->rxInvalid++;
+        return false;
+    }
+    UARTMuxChannel *channel = &mux->channels[frame[0]];
+    const uint8_t *payload = frame + 1;
+    len--;
+    if (uart_rxReserve(channel->buffer, spans) < len)
+    {
+        channel->rxDropped++;
+        return false;
+    }
+    size_t first = (spans[0].len < len) ? spans[0].len : len;
+    memcpy(spans[0].data, payload, first);
+    memcpy(spans[1].data, payload + first, len - first);
+    uart_rxCommit(channel->buffer, len);
+    return true;
+}
+
+void uart_muxInit(UARTMux *mux, UARTBuffer *link, UART_FrameType type, uint8_t *rxFrame, uint8_t *txFrame, size_t frameSize)
+{
+    mux->link = link;
+    mux->type = type;
+    uart_frameDecoderInit(&mux->decoder, type, rxFrame, frameSize, NULL, NULL);
+    mux->txFrame = txFrame;
+    mux->frameSize = frameSize;
+    memset(mux->channels, 0, sizeof(mux->channels));
+    mux->next = 0;
+    mux->rxInvalid = 0;
+}
+
+bool uart_muxAddChannel(UARTMux *mux, uint8_t id, UARTBuffer *buffer, uint16_t weight)
+{
+    if (id >= UART_MUX_MAX_CHANNELS)
+        return false;
+    uart_txInit(buffer, uart_muxTxEnable, 0);
+    mux->channels[id].buffer = buffer;
+    mux->channels[id].weight = (weight != 0) ? weight : 1;
+    mux->channels[id].deficit = 0;
+    mux->channels[id].credited = false;
+    mux->channels[id].rxDropped = 0;
+    return true;
+}
+
+bool uart_muxWrite(UARTMux *mux, uint8_t id, const void *data, size_t len)
+{
+    uint8_t header[UART_MUX_RECORD_HEADER] = {(uint8_t)len, (uint8_t)(len >> 8)};
+    if (id >= UART_MUX_MAX_CHANNELS || mux->channels[id].buffer == NULL)
+        return false;
+    UARTBuffer *buffer = mux->channels[id].buffer;
+    if (len >= mux->frameSize || len > 0xFFFF || uart_txSpace(buffer) < UART_MUX_RECORD_HEADER + len)
+        return false;
+    // uart_muxPending ignores the record until its payload is queued as well
+    uart_writeAsync(buffer, header, UART_MUX_RECORD_HEADER);
+    uart_writeAsync(buffer, data, len);
+    return true;
+}
+
+size_t uart_muxReceive(UARTMux *mux)
+{
+    size_t frames = 0;
+    size_t len;
+    while ((len = uart_frameRead(mux->link, &mux->decoder)) != 0)
+    {
+        if (uart_muxDeliver(mux, mux->decoder.frame, len))
+            frames++;
+    }
+    return frames;
+}
+
+size_t uart_muxTransmit(UARTMux *mux)
+{
+    size_t frames = 0;
+    unsigned idle = 0;      // Consecutive channels visited with nothing queued
+    while (idle < UART_MUX_MAX_CHANNELS)
+    {
+        UARTMuxChannel *channel = &mux->channels[mux->next];
+        UARTSpan spans[2];
+        size_t len;
+        if (channel->buffer == NULL || !uart_muxPending(channel, spans, &len))
+        {
+            // Empty channels don't keep credit
+            channel->deficit = 0;
+            channel->credited = false;
+            mux->next = (uint8_t)((mux->next + 1) % UART_MUX_MAX_CHANNELS);
+            idle++;
+            continue;
+        }
+        idle = 0;
+        if (!channel->credited)
+        {
+            channel->deficit += channel->weight;
+            channel->credited = true;
+        }
+        if (len > channel->deficit)
+        {
+            channel->credited = false;
+            mux->next = (uint8_t)((mux->next + 1) % UART_MUX_MAX_CHANNELS);
+            continue;
+        }
+        if (!uart_muxLinkFits(mux, len + 1))
+            break;
+        mux->txFrame[0] = (uint8_t)(channel - mux->channels);
+        uart_muxSpanCopy(spans, UART_MUX_RECORD_HEADER, mux->txFrame + 1, len);
+        uart_txConsume(channel->buffer, UART_MUX_RECORD_HEADER + len);
+        uart_frameWrite(mux->link, mux->type, mux->txFrame, len + 1);
+        channel->deficit -= len;
+        frames++;
+    }
+    return frames;
+}
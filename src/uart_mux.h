@@ -0,0 +1,135 @@
+/**
+ * @file uart_mux.h
+ * @author Roberto Parra (uedsoldier1990@gmail.com)
+ * @brief Virtual channel multiplexing over a single framed UART link
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef UART_MUX_H
+#define UART_MUX_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#pragma region Dependencies
+#include "uart_frame.h"
+#pragma endregion
+
+#if !(defined(UART_MULTIPLE_BUFFERS) && (UART_MULTIPLE_BUFFERS > 0))
+#error "uart_mux needs UART_MULTIPLE_BUFFERS: every channel is a UART buffer of its own"
+#endif
+
+/**
+ * @brief Maximum channel quantity per link
+ */
+#ifndef UART_MUX_MAX_CHANNELS
+#define UART_MUX_MAX_CHANNELS 8
+#endif
+
+/**
+ * @brief Bytes ahead of every frame queued in a channel TX ring (little endian payload length)
+ */
+#define UART_MUX_RECORD_HEADER 2
+
+/*
+ * Link format: every frame is a COBS or SLIP frame whose first byte is the channel ID, followed by the
+ * payload.
+ *
+ * Each channel is a regular UART buffer (uart_buffer_initStorage; readByte/writeByte aren't used):
+ * - RX: received payloads are demultiplexed straight into its RX ring (uart_rxReserve/uart_rxCommit), so
+ *   the application reads the channel with uart_readBuffer, uart_gets, uart_peek... and wait hooks work.
+ *   A payload that doesn't fit is dropped as a whole
+ * - TX: uart_muxWrite queues payloads as length-prefixed records in its TX ring. uart_muxTransmit moves
+ *   them to the link with deficit round robin: every visit a channel earns 'weight' bytes of credit and
+ *   sends queued frames while its credit covers them, so a busy log channel can't starve RPC replies
+ */
+
+/**
+ * @brief Channel state
+ */
+typedef struct _UARTMuxChannel{
+    UARTBuffer *buffer;     // NULL if channel not in use
+    uint16_t weight;        // Bytes of credit earned per scheduling round
+    size_t deficit;         // Current credit
+    bool credited;          // Credit already earned in current visit
+    uint32_t rxDropped;     // Received frames dropped (RX ring full)
+} UARTMuxChannel;
+
+/**
+ * @brief Multiplexer state
+ */
+typedef struct _UARTMux{
+    UARTBuffer *link;           // Physical UART buffer
+    UART_FrameType type;
+    UARTFrameDecoder decoder;   // Decodes link frames into rxFrame
+    uint8_t *txFrame;           // Assembles channel ID and payload for the frame encoder
+    size_t frameSize;           // rxFrame/txFrame size: max payload + 1
+    UARTMuxChannel channels[UART_MUX_MAX_CHANNELS];
+    uint8_t next;               // Channel being visited by the scheduler
+    uint32_t rxInvalid;         // Received frames for unknown channels (or empty)
+} UARTMux;
+
+#pragma region Function prototypes
+
+/**
+ * @brief Multiplexer initialization
+ * @param mux Reference to multiplexer
+ * @param link Reference to physical UART buffer. If its TX ring is enabled, it's checked for space before
+ * sending, so it must hold at least one worst case encoded frame
+ * @param type Framing type
+ * @param rxFrame Reference to receive frame storage
+ * @param txFrame Reference to transmit frame storage
+ * @param frameSize Size of each frame storage in bytes (max payload + 1)
+ */
+void uart_muxInit(UARTMux *mux, UARTBuffer *link, UART_FrameType type, uint8_t *rxFrame, uint8_t *txFrame, size_t frameSize);
+
+/**
+ * @brief Adds a channel. Its TX ring is enabled (uart_txInit) to queue outgoing frames
+ * @param mux Reference to multiplexer
+ * @param id Channel ID (0 to UART_MUX_MAX_CHANNELS - 1)
+ * @param buffer Reference to initialized channel UART buffer
+ * @param weight Bytes of credit per scheduling round (at least 1), relative share of link bandwidth
+ * @return true Channel added
+ * @return false Invalid ID
+ */
+bool uart_muxAddChannel(UARTMux *mux, uint8_t id, UARTBuffer *buffer, uint16_t weight);
+
+/**
+ * @brief Queues a frame on a channel, without waiting. Call from the channel writer context
+ * @param mux Reference to multiplexer
+ * @param id Channel ID
+ * @param data Payload
+ * @param len Payload length (up to frameSize - 1)
+ * @return true Frame queued
+ * @return false Unknown channel, payload too long or not enough room in channel TX ring
+ */
+bool uart_muxWrite(UARTMux *mux, uint8_t id, const void *data, size_t len);
+
+/**
+ * @brief Decodes all received link data in one pass and delivers every frame to its channel RX ring
+ * @param mux Reference to multiplexer
+ * @return size_t Frames delivered
+ */
+size_t uart_muxReceive(UARTMux *mux);
+
+/**
+ * @brief Sends queued frames with weighted scheduling until every channel is empty or the link TX ring
+ * can't take the next frame (scheduling then resumes from the same channel)
+ * @param mux Reference to multiplexer
+ * @return size_t Frames sent
+ */
+size_t uart_muxTransmit(UARTMux *mux);
+
+#pragma endregion
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*UART_MUX_H*/
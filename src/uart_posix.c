@@ -0,0 +1,316 @@
+/**
+ * @file uart_posix.c
+ * @author Roberto Parra (uedsoldier1990@gmail.com)
+ * @brief
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "uart_posix.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <termios.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/uio.h>
+
+/**
+ * @brief Standard baud rates and their termios constants
+ */
+static const struct {
+    uint32_t baudRate;
+    speed_t speed;
+} uart_posixSpeeds[] = {
+    {1200, B1200}, {2400, B2400}, {4800, B4800}, {9600, B9600}, {19200, B19200}, {38400, B38400},
+    {57600, B57600}, {115200, B115200}, {230400, B230400},
+#ifdef B460800
+    {460800, B460800}, {921600, B921600}, {1000000, B1000000}, {2000000, B2000000},
+#endif
+#ifdef B4000000
+    {3000000, B3000000}, {4000000, B4000000},
+#endif
+};
+
+/**
+ * @brief TX-empty "interrupt" enable. Nothing to do: uart_posixPoll sends queued data before waiting and
+ * registers EPOLLOUT while data is left
+ */
+static void uart_posixTxEnable(bool enable)
+{
+    (void)enable;
+}
+
+/**
+ * @brief Updates epoll registration of port fd, only when it changes
+ */
+static int uart_posixSetEvents(UARTPosixPort *port, uint32_t events)
+{
+    if (events == port->events)
+        return 0;
+    struct epoll_event event = {.events = events, .data.fd = port->fd};
+    if (epoll_ctl(port->epollFd, EPOLL_CTL_MOD, port->fd, &event) != 0)
+        return -1;
+    port->events = events;
+    return 0;
+}
+
+/**
+ * @brief Writes queued TX data straight from the ring (up to two segments per call)
+ * @return int 0 when done (sent or would block), -1 on error
+ */
+static int uart_posixSend(UARTPosixPort *port)
+{
+    UARTSpan spans[2];
+    while (uart_txPeek(UART_BUFFER_ARG(port->buffer) spans) != 0)
+    {
+        struct iovec iov[2] = {{spans[0].data, spans[0].len}, {spans[1].data, spans[1].len}};
+        ssize_t count = writev(port->fd, iov, spans[1].len ? 2 : 1);
+        if (count < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+        }
+        uart_txConsume(UART_BUFFER_ARG(port->buffer) (size_t)count);
+    }
+    return 0;
+}
+
+/**
+ * @brief Reads available data straight into the RX ring free segments, until the fd would block or
+ * the ring is full
+ * @return int Received byte quantity, -1 on error or hang-up
+ */
+static int uart_posixReceive(UARTPosixPort *port)
+{
+    UARTSpan spans[2];
+    int received = 0;
+    while (uart_rxReserve(UART_BUFFER_ARG(port->buffer) spans) != 0)
+    {
+        struct iovec iov[2] = {{spans[0].data, spans[0].len}, {spans[1].data, spans[1].len}};
+        ssize_t count = readv(port->fd, iov, spans[1].len ? 2 : 1);
+        if (count < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                break;
+            if (errno == EIO)   // pty peer closed
+                errno = EPIPE;
+            return -1;
+        }
+        if (count == 0)
+        {
+            errno = EPIPE;
+            return -1;
+        }
+        uart_rxCommit(UART_BUFFER_ARG(port->buffer) (size_t)count);
+        received += (int)count;
+        if ((size_t)count != spans[0].len + spans[1].len)
+            break;      // Short read: nothing else pending
+    }
+    return received;
+}
+
+int uart_posixConfigure(int fd, uint32_t baudRate)
+{
+    struct termios tio;
+    if (tcgetattr(fd, &tio) != 0)
+        return -1;
+    cfmakeraw(&tio);
+    tio.c_cflag |= CLOCAL | CREAD;
+    tio.c_cc[VMIN] = 0;
+    tio.c_cc[VTIME] = 0;
+    if (baudRate != 0)
+    {
+        size_t i;
+        for (i = 0; i != sizeof(uart_posixSpeeds) / sizeof(uart_posixSpeeds[0]); i++)
+        {
+            if (uart_posixSpeeds[i].baudRate == baudRate)
+                break;
+        }
+        if (i == sizeof(uart_posixSpeeds) / sizeof(uart_posixSpeeds[0]))
+        {
+            errno = EINVAL;
+            return -1;
+        }
+        cfsetispeed(&tio, uart_posixSpeeds[i].speed);
+        cfsetospeed(&tio, uart_posixSpeeds[i].speed);
+    }
+    return tcsetattr(fd, TCSANOW, &tio);
+}
+
+int uart_posixAttach(UARTPosixPort *port, UART_BUFFER_PARAM int fd, uint32_t baudRate)
+{
+    int flags = fcntl(fd, F_GETFL);
+    if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) != 0)
+        return -1;
+
+#if defined(UART_MULTIPLE_BUFFERS) && (UART_MULTIPLE_BUFFERS > 0)
+    port->buffer = uartBuffer;
+#endif
+    port->fd = fd;
+    port->ownsFd = false;
+    port->events = EPOLLIN;
+    port->epollFd = epoll_create1(EPOLL_CLOEXEC);
+    port->wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (port->epollFd < 0 || port->wakeFd < 0)
+        goto error;
+
+    struct epoll_event event = {.events = EPOLLIN, .data.fd = fd};
+    if (epoll_ctl(port->epollFd, EPOLL_CTL_ADD, fd, &event) != 0)
+        goto error;
+    event.data.fd = port->wakeFd;
+    if (epoll_ctl(port->epollFd, EPOLL_CTL_ADD, port->wakeFd, &event) != 0)
+        goto error;
+
+    uart_txInit(UART_BUFFER_ARG(port->buffer) uart_posixTxEnable, baudRate);
+    return 0;
+
+error:
+    {
+        int error = errno;
+        if (port->epollFd >= 0)
+            close(port->epollFd);
+        if (port->wakeFd >= 0)
+            close(port->wakeFd);
+        port->epollFd = port->wakeFd = -1;
+        errno = error;
+    }
+    return -1;
+}
+
+/**
+ * @brief Takes ownership of an opened tty fd and attaches it, closing it on failure
+ */
+static int uart_posixAdopt(UARTPosixPort *port, UART_BUFFER_PARAM int fd, uint32_t baudRate)
+{
+    if (fd >= 0 && uart_posixAttach(port, UART_BUFFER_ARG(uartBuffer) fd, baudRate) == 0)
+    {
+        port->ownsFd = true;
+        return 0;
+    }
+    if (fd >= 0)
+    {
+        int error = errno;
+        close(fd);
+        errno = error;
+    }
+    return -1;
+}
+
+/**
+ * @brief Opens a tty device and sets it in raw mode
+ */
+static int uart_posixOpenDevice(const char *path, uint32_t baudRate)
+{
+    int fd = open(path, O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+    if (fd >= 0 && uart_posixConfigure(fd, baudRate) != 0)
+    {
+        int error = errno;
+        close(fd);
+        errno = error;
+        return -1;
+    }
+    return fd;
+}
+
+/**
+ * @brief Creates a raw mode pseudo-terminal and returns its master fd
+ */
+static int uart_posixOpenMaster(char *slavePath, size_t len)
+{
+    int fd = posix_openpt(O_RDWR | O_NOCTTY | O_CLOEXEC);
+    if (fd < 0)
+        return -1;
+    if (grantpt(fd) != 0 || unlockpt(fd) != 0 || ptsname_r(fd, slavePath, len) != 0 || uart_posixConfigure(fd, 0) != 0)
+    {
+        int error = errno;
+        close(fd);
+        errno = error;
+        return -1;
+    }
+    return fd;
+}
+
+int uart_posixOpen(UARTPosixPort *port, UART_BUFFER_PARAM const char *path, uint32_t baudRate)
+{
+    return uart_posixAdopt(port, UART_BUFFER_ARG(uartBuffer) uart_posixOpenDevice(path, baudRate), baudRate);
+}
+
+int uart_posixOpenPty(UARTPosixPort *port, UART_BUFFER_PARAM char *slavePath, size_t len)
+{
+    return uart_posixAdopt(port, UART_BUFFER_ARG(uartBuffer) uart_posixOpenMaster(slavePath, len), 0);
+}
+
+int uart_posixPoll(UARTPosixPort *port, int timeout)
+{
+    struct epoll_event events[2];
+    UARTSpan spans[2];
+    int received = 0;
+
+    if (uart_posixSend(port) != 0)
+        return -1;
+    // Reading pauses while RX ring is full, writing is only watched while TX data is left
+    uint32_t wanted = (uart_rxReserve(UART_BUFFER_ARG(port->buffer) spans) != 0 ? EPOLLIN : 0) |
+                      (uart_txPeek(UART_BUFFER_ARG(port->buffer) spans) != 0 ? EPOLLOUT : 0);
+    if (uart_posixSetEvents(port, wanted) != 0)
+        return -1;
+
+    int count = epoll_wait(port->epollFd, events, 2, timeout);
+    if (count < 0)
+        return (errno == EINTR) ? 0 : -1;
+    for (int i = 0; i != count; i++)
+    {
+        if (events[i].data.fd == port->wakeFd)
+        {
+            uint64_t value;
+            if (read(port->wakeFd, &value, sizeof(value)) < 0 && errno != EAGAIN)
+                return -1;
+            continue;
+        }
+        if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR))
+        {
+            int result = uart_posixReceive(port);
+            if (result < 0)
+                return -1;
+            received += result;
+            if ((events[i].events & (EPOLLHUP | EPOLLERR)) && result == 0)
+            {
+                errno = EPIPE;
+                return -1;
+            }
+        }
+        if ((events[i].events & EPOLLOUT) && uart_posixSend(port) != 0)
+            return -1;
+    }
+    return received;
+}
+
+void uart_posixKick(UARTPosixPort *port)
+{
+    uint64_t value = 1;
+    ssize_t result = write(port->wakeFd, &value, sizeof(value));
+    (void)result;
+}
+
+void uart_posixClose(UARTPosixPort *port)
+{
+    if (port->epollFd >= 0)
+        close(port->epollFd);
+    if (port->wakeFd >= 0)
+        close(port->wakeFd);
+    if (port->ownsFd && port->fd >= 0)
+        close(port->fd);
+    port->epollFd = port->wakeFd = port->fd = -1;
+}
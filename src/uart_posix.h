@@ -0,0 +1,109 @@
+/**
+ * @file uart_posix.h
+ * @author Roberto Parra (uedsoldier1990@gmail.com)
+ * @brief Linux host backend: attaches a UART buffer to a tty or pseudo-terminal, driven by epoll
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef UART_POSIX_H
+#define UART_POSIX_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#pragma region Dependencies
+#include "uart_buffer.h"
+#pragma endregion
+
+/**
+ * @brief Host port state. Received data is read (readv) straight into the RX ring free spans and queued
+ * TX data is written (writev) straight from the TX ring, so there is no intermediate copy
+ */
+typedef struct _UARTPosixPort{
+#if defined(UART_MULTIPLE_BUFFERS) && (UART_MULTIPLE_BUFFERS > 0)
+    UARTBuffer *buffer;
+#endif
+    int fd;             // tty/pty file descriptor (non-blocking)
+    int epollFd;
+    int wakeFd;         // eventfd used by uart_posixKick to interrupt uart_posixPoll
+    uint32_t events;    // epoll events currently registered for fd
+    bool ownsFd;        // fd is closed by uart_posixClose
+} UARTPosixPort;
+
+#pragma region Function prototypes
+
+/**
+ * @brief Sets a tty file descriptor in raw mode (8N1, no echo, no line discipline processing)
+ * @param fd tty file descriptor
+ * @param baudRate Baud rate (0 to keep current setting, ignored by pseudo-terminals)
+ * @return int 0 on success, -1 on error (errno set)
+ */
+int uart_posixConfigure(int fd, uint32_t baudRate);
+
+/**
+ * @brief Attaches an already opened file descriptor to UART buffer. UART buffer must be initialized, its
+ * TX ring is enabled (uart_txInit) so that write functions queue data for uart_posixPoll
+ * @param port Reference to port
+ * @param uartBuffer Reference to UART buffer (parameter only present with UART_MULTIPLE_BUFFERS)
+ * @param fd File descriptor, set to non-blocking mode. Not closed by uart_posixClose
+ * @param baudRate Baud rate used for drain time estimation
+ * @return int 0 on success, -1 on error (errno set)
+ */
+int uart_posixAttach(UARTPosixPort *port, UART_BUFFER_PARAM int fd, uint32_t baudRate);
+
+/**
+ * @brief Opens a tty (serial port or pty slave) in raw mode and attaches it to UART buffer
+ * @param port Reference to port
+ * @param uartBuffer Reference to UART buffer (parameter only present with UART_MULTIPLE_BUFFERS)
+ * @param path Device path (e.g. /dev/ttyUSB0)
+ * @param baudRate Baud rate
+ * @return int 0 on success, -1 on error (errno set)
+ */
+int uart_posixOpen(UARTPosixPort *port, UART_BUFFER_PARAM const char *path, uint32_t baudRate);
+
+/**
+ * @brief Creates a pseudo-terminal and attaches its master side to UART buffer. The slave side (the
+ * other end of the loopback) can be opened with uart_posixOpen or by any serial application
+ * @param port Reference to port
+ * @param uartBuffer Reference to UART buffer (parameter only present with UART_MULTIPLE_BUFFERS)
+ * @param slavePath Reference to char array that will store slave device path
+ * @param len slavePath size in bytes
+ * @return int 0 on success, -1 on error (errno set)
+ */
+int uart_posixOpenPty(UARTPosixPort *port, UART_BUFFER_PARAM char *slavePath, size_t len);
+
+/**
+ * @brief Services the port: sends queued TX data, waits up to 'timeout' milliseconds for events and moves
+ * received data into the RX ring. Reading pauses while the RX ring is full (the kernel keeps buffering)
+ * @param port Reference to port
+ * @param timeout Timeout in milliseconds (-1 waits forever, 0 doesn't wait)
+ * @return int Received byte quantity, or -1 on error or hang-up (errno set, EPIPE on hang-up)
+ */
+int uart_posixPoll(UARTPosixPort *port, int timeout);
+
+/**
+ * @brief Interrupts a uart_posixPoll call blocked in another thread, e.g. after queuing TX data or
+ * consuming RX data from a full ring
+ * @param port Reference to port
+ */
+void uart_posixKick(UARTPosixPort *port);
+
+/**
+ * @brief Releases port resources
+ * @param port Reference to port
+ */
+void uart_posixClose(UARTPosixPort *port);
+
+#pragma endregion
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*UART_POSIX_H*/
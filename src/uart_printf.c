@@ -0,0 +1,501 @@
+/**
+ * @file uart_printf.c
+ * @author Roberto Parra (uedsoldier1990@gmail.com)
+ * @brief
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include "uart_printf.h"
+#if defined(UART_PRINTF_FLOAT) && (UART_PRINTF_FLOAT > 0)
+#include <math.h>
+#endif
+
+/**
+ * @brief Conversion flags
+ */
+#define UART_PRINTF_LEFT    0x01
+#define UART_PRINTF_ZERO    0x02
+#define UART_PRINTF_PLUS    0x04
+#define UART_PRINTF_SPACE   0x08
+#define UART_PRINTF_ALT     0x10
+
+/**
+ * @brief Room for the longest conversion: 64-bit octal (22 digits) or %f integer part, '.' and fraction
+ */
+#define UART_PRINTF_DIGITS  32
+
+/**
+ * @brief Parsed conversion specification
+ */
+typedef struct _UARTPrintfSpec{
+    uint8_t flags;
+    size_t width;
+    int precision;      // -1 when not given
+} UARTPrintfSpec;
+
+static const char uart_printfPairs[201] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+static const char uart_printfHexLower[16] = "0123456789abcdef";
+static const char uart_printfHexUpper[16] = "0123456789ABCDEF";
+
+static const uint32_t uart_printfPow10[UART_PRINTF_MAX_PRECISION + 1] = {
+    1UL, 10UL, 100UL, 1000UL, 10000UL, 100000UL, 1000000UL, 10000000UL, 100000000UL, 1000000000UL
+};
+
+/**
+ * @brief Writes the decimal digits of 'value' backwards, ending right before 'end', two digits per
+ * division. Values fitting 32 bits avoid 64-bit divisions (slow on small cores)
+ * @return size_t Digit quantity
+ */
+static size_t uart_printfDecimal(char *end, uintmax_t value)
+{
+    char *p = end;
+    while (value > UINT32_MAX)
+    {
+        unsigned pair = (unsigned)(value % 100);
+        value /= 100;
+        p -= 2;
+        memcpy(p, &uart_printfPairs[pair * 2], 2);
+    }
+    uint32_t low = (uint32_t)value;
+    while (low >= 100)
+    {
+        unsigned pair = (unsigned)(low % 100);
+        low /= 100;
+        p -= 2;
+        memcpy(p, &uart_printfPairs[pair * 2], 2);
+    }
+    if (low >= 10)
+    {
+        p -= 2;
+        memcpy(p, &uart_printfPairs[low * 2], 2);
+    }
+    else
+    {
+        *--p = (char)('0' + low);
+    }
+    return (size_t)(end - p);
+}
+
+/**
+ * @brief Writes the base 2^shift digits (hex or octal) of 'value' backwards, ending right before 'end'
+ * @return size_t Digit quantity
+ */
+static size_t uart_printfPower2(char *end, uintmax_t value, unsigned shift, const char *digits)
+{
+    char *p = end;
+    unsigned mask = (1U << shift) - 1;
+    do
+    {
+        *--p = digits[value & mask];
+        value >>= shift;
+    } while (value != 0);
+    return (size_t)(end - p);
+}
+
+/**
+ * @brief Writes 'n' copies of a padding character
+ */
+static void uart_printfPad(UART_BUFFER_PARAM char c, size_t n)
+{
+    static const char spaces[16] = {' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' '};
+    static const char zeros[16] = {'0', '0', '0', '0', '0', '0', '0', '0', '0', '0', '0', '0', '0', '0', '0', '0'};
+    const char *run = (c == '0') ? zeros : spaces;
+    while (n != 0)
+    {
+        size_t count = (n < sizeof(spaces)) ? n : sizeof(spaces);
+        uart_write(UART_BUFFER_ARG(uartBuffer) (void *)run, count);
+        n -= count;
+    }
+}
+
+/**
+ * @brief Writes a converted field: padding, prefix (sign, 0x...), leading zeros, body and trailing zeros
+ * @return size_t Written character quantity
+ */
+static size_t uart_printfField(UART_BUFFER_PARAM const UARTPrintfSpec *spec, const char *prefix, size_t prefixLen, size_t zeros, const char *body, size_t len, size_t trailing)
+{
+    size_t total = prefixLen + zeros + len + trailing;
+    size_t pad = (spec->width > total) ? spec->width - total : 0;
+    if ((spec->flags & UART_PRINTF_ZERO) && !(spec->flags & UART_PRINTF_LEFT))
+    {
+        zeros += pad;
+        pad = 0;
+    }
+    if (!(spec->flags & UART_PRINTF_LEFT))
+        uart_printfPad(UART_BUFFER_ARG(uartBuffer) ' ', pad);
+    if (prefixLen != 0)
+        uart_write(UART_BUFFER_ARG(uartBuffer) (void *)prefix, prefixLen);
+    uart_printfPad(UART_BUFFER_ARG(uartBuffer) '0', zeros);
+    if (len != 0)
+        uart_write(UART_BUFFER_ARG(uartBuffer) (void *)body, len);
+    uart_printfPad(UART_BUFFER_ARG(uartBuffer) '0', trailing);
+    if (spec->flags & UART_PRINTF_LEFT)
+        uart_printfPad(UART_BUFFER_ARG(uartBuffer) ' ', pad);
+    return prefixLen + zeros + len + trailing + pad;
+}
+
+/**
+ * @brief Sign character for a conversion, if any
+ * @return size_t Sign length (0 or 1)
+ */
+static size_t uart_printfSign(const UARTPrintfSpec *spec, bool negative, char *sign)
+{
+    if (negative)
+        *sign = '-';
+    else if (spec->flags & UART_PRINTF_PLUS)
+        *sign = '+';
+    else if (spec->flags & UART_PRINTF_SPACE)
+        *sign = ' ';
+    else
+        return 0;
+    return 1;
+}
+
+/**
+ * @brief Writes integer and fractional parts as "integer.fraction" with 'decimals' fractional digits,
+ * followed by 'padding' zeros
+ * @return size_t Written character quantity
+ */
+static size_t uart_printfDecimalFixed(UART_BUFFER_PARAM const UARTPrintfSpec *spec, bool negative, uintmax_t integer, uint32_t fraction, unsigned decimals, size_t padding)
+{
+    char digits[UART_PRINTF_DIGITS];
+    char *end = digits + sizeof(digits);
+    char *p = end;
+    char sign;
+    if (decimals != 0)
+    {
+        size_t count = uart_printfDecimal(p, fraction);
+        p -= count;
+        while (count++ < decimals)
+        {
+            *--p = '0';
+        }
+    }
+    if (decimals != 0 || padding != 0 || (spec->flags & UART_PRINTF_ALT))
+        *--p = '.';
+    p -= uart_printfDecimal(p, integer);
+    size_t signLen = uart_printfSign(spec, negative, &sign);
+    return uart_printfField(UART_BUFFER_ARG(uartBuffer) spec, &sign, signLen, 0, p, (size_t)(end - p), padding);
+}
+
+#if defined(UART_PRINTF_FLOAT) && (UART_PRINTF_FLOAT > 0)
+/**
+ * @brief %f conversion. The fraction is scaled by 10^precision and rounded once, so the whole conversion
+ * takes a couple of floating point operations and integer digit generation. Exact halfway values round to
+ * even like the C library (0.125 with %.2f gives "0.12"). Digits past UART_PRINTF_MAX_PRECISION are zeros
+ */
+static size_t uart_printfFloat(UART_BUFFER_PARAM UARTPrintfSpec *spec, double value)
+{
+    bool negative = signbit(value) != 0;
+    if (negative)
+        value = -value;
+    if (value != value || value >= 18446744073709551616.0)
+    {
+        char sign;
+        const char *text = (value != value) ? "nan" : "inf";
+        size_t signLen = uart_printfSign(spec, negative, &sign);
+        spec->flags &= (uint8_t)~UART_PRINTF_ZERO;
+        if (signLen == 0)
+            return uart_printfField(UART_BUFFER_ARG(uartBuffer) spec, NULL, 0, 0, text, 3, 0);
+        return uart_printfField(UART_BUFFER_ARG(uartBuffer) spec, &sign, 1, 0, text, 3, 0);
+    }
+    unsigned decimals = (spec->precision < 0) ? 6 : (unsigned)spec->precision;
+    size_t padding = 0;
+    if (decimals > UART_PRINTF_MAX_PRECISION)
+    {
+        padding = decimals - UART_PRINTF_MAX_PRECISION;
+        decimals = UART_PRINTF_MAX_PRECISION;
+    }
+    uint64_t integer = (uint64_t)value;
+    double part = value - (double)integer;     // Exact
+    double scaled = part * (double)uart_printfPow10[decimals];
+    uint32_t fraction = (uint32_t)scaled;
+    // Zero filled digits follow the truncated ones: rounding the last converted digit would make them wrong
+    if (padding == 0)
+    {
+        double rest = scaled - (double)fraction;
+        // part * 10^decimals is exactly halfway only when part * 2^(decimals + 1) is an odd integer (exact test)
+        double half = part * (double)(2UL << decimals);
+        if (half == (double)(uint32_t)half && ((uint32_t)half & 1U) != 0)
+        {
+            if (((decimals != 0) ? fraction : (uint32_t)integer) & 1U)
+                fraction++;
+        }
+        else if (rest >= 0.5)
+        {
+            fraction++;
+        }
+    }
+    if (fraction >= uart_printfPow10[decimals])
+    {
+        fraction -= uart_printfPow10[decimals];
+        integer++;
+    }
+    return uart_printfDecimalFixed(UART_BUFFER_ARG(uartBuffer) spec, negative, integer, fraction, decimals, padding);
+}
+#endif
+
+int uart_vprintf(UART_BUFFER_PARAM const char *format, va_list args)
+{
+    size_t count = 0;
+    while (*format != '\0')
+    {
+        // Literal text is written as a single run
+        const char *run = format;
+        while (*format != '\0' && *format != '%')
+        {
+            format++;
+        }
+        if (format != run)
+        {
+            uart_write(UART_BUFFER_ARG(uartBuffer) (void *)run, (size_t)(format - run));
+            count += (size_t)(format - run);
+        }
+        if (*format == '\0')
+            break;
+        const char *start = format++;
+
+        UARTPrintfSpec spec = {0, 0, -1};
+        for (;; format++)
+        {
+            if (*format == '-')
+                spec.flags |= UART_PRINTF_LEFT;
+            else if (*format == '0')
+                spec.flags |= UART_PRINTF_ZERO;
+            else if (*format == '+')
+                spec.flags |= UART_PRINTF_PLUS;
+            else if (*format == ' ')
+                spec.flags |= UART_PRINTF_SPACE;
+            else if (*format == '#')
+                spec.flags |= UART_PRINTF_ALT;
+            else
+                break;
+        }
+        if (*format == '*')
+        {
+            int width = va_arg(args, int);
+            if (width < 0)
+            {
+                spec.flags |= UART_PRINTF_LEFT;
+                width = -width;
+            }
+            spec.width = (size_t)width;
+            format++;
+        }
+        while (*format >= '0' && *format <= '9')
+        {
+            spec.width = spec.width * 10 + (size_t)(*format++ - '0');
+        }
+        if (*format == '.')
+        {
+            format++;
+            spec.precision = 0;
+            if (*format == '*')
+            {
+                spec.precision = va_arg(args, int);
+                format++;
+            }
+            while (*format >= '0' && *format <= '9')
+            {
+                spec.precision = spec.precision * 10 + (*format++ - '0');
+            }
+        }
+
+        char length = 0;    // 'H': hh, 'h', 'l', 'L': ll, 'z', 'j', 't'
+        if (*format == 'h' || *format == 'l')
+        {
+            length = *format++;
+            if (*format == length)
+            {
+                length = (length == 'h') ? 'H' : 'L';
+                format++;
+            }
+        }
+        else if (*format == 'z' || *format == 'j' || *format == 't')
+        {
+            length = *format++;
+        }
+
+        char digits[UART_PRINTF_DIGITS];
+        char *end = digits + sizeof(digits);
+        char prefix[2];
+        size_t prefixLen = 0;
+        size_t len;
+        uintmax_t value;
+        char conversion = *format++;
+        switch (conversion)
+        {
+        case 'd':
+        case 'i':
+        {
+            intmax_t number;
+            switch (length)
+            {
+            case 'H': number = (signed char)va_arg(args, int); break;
+            case 'h': number = (short)va_arg(args, int); break;
+            case 'l': number = va_arg(args, long); break;
+            case 'L': number = va_arg(args, long long); break;
+            case 'z': number = (intmax_t)(ptrdiff_t)va_arg(args, size_t); break;
+            case 'j': number = va_arg(args, intmax_t); break;
+            case 't': number = va_arg(args, ptrdiff_t); break;
+            default: number = va_arg(args, int); break;
+            }
+            value = (number < 0) ? (uintmax_t)0 - (uintmax_t)number : (uintmax_t)number;
+            prefixLen = uart_printfSign(&spec, number < 0, prefix);
+            len = (spec.precision == 0 && value == 0) ? 0 : uart_printfDecimal(end, value);
+            break;
+        }
+        case 'u':
+        case 'o':
+        case 'x':
+        case 'X':
+        case 'p':
+            if (conversion == 'p')
+            {
+                value = (uintptr_t)va_arg(args, void *);
+                if (value == 0)
+                {
+                    // Same text as glibc
+                    spec.flags &= (uint8_t)~UART_PRINTF_ZERO;
+                    count += uart_printfField(UART_BUFFER_ARG(uartBuffer) &spec, NULL, 0, 0, "(nil)", 5, 0);
+                    continue;
+                }
+                conversion = 'x';
+                spec.flags |= UART_PRINTF_ALT;
+            }
+            else
+            {
+                switch (length)
+                {
+                case 'H': value = (unsigned char)va_arg(args, unsigned); break;
+                case 'h': value = (unsigned short)va_arg(args, unsigned); break;
+                case 'l': value = va_arg(args, unsigned long); break;
+                case 'L': value = va_arg(args, unsigned long long); break;
+                case 'z': value = va_arg(args, size_t); break;
+                case 'j': value = va_arg(args, uintmax_t); break;
+                case 't': value = (uintmax_t)va_arg(args, ptrdiff_t); break;
+                default: value = va_arg(args, unsigned); break;
+                }
+            }
+            if (spec.precision == 0 && value == 0)
+                len = 0;
+            else if (conversion == 'u')
+                len = uart_printfDecimal(end, value);
+            else if (conversion == 'o')
+                len = uart_printfPower2(end, value, 3, uart_printfHexLower);
+            else
+                len = uart_printfPower2(end, value, 4, (conversion == 'X') ? uart_printfHexUpper : uart_printfHexLower);
+            if ((spec.flags & UART_PRINTF_ALT) && value != 0 && (conversion == 'x' || conversion == 'X'))
+            {
+                prefix[0] = '0';
+                prefix[1] = conversion;
+                prefixLen = 2;
+            }
+            else if ((spec.flags & UART_PRINTF_ALT) && conversion == 'o' && (len == 0 || end[-(ptrdiff_t)len] != '0') && spec.precision <= (int)len)
+            {
+                *(end - ++len) = '0';
+            }
+            break;
+        case 'c':
+            digits[0] = (char)va_arg(args, int);
+            spec.flags &= (uint8_t)~UART_PRINTF_ZERO;
+            count += uart_printfField(UART_BUFFER_ARG(uartBuffer) &spec, NULL, 0, 0, digits, 1, 0);
+            continue;
+        case 's':
+        {
+            const char *str = va_arg(args, const char *);
+            if (str == NULL)
+                str = "(null)";
+            len = 0;
+            while (str[len] != '\0' && (spec.precision < 0 || len < (size_t)spec.precision))
+            {
+                len++;
+            }
+            spec.flags &= (uint8_t)~UART_PRINTF_ZERO;
+            count += uart_printfField(UART_BUFFER_ARG(uartBuffer) &spec, NULL, 0, 0, str, len, 0);
+            continue;
+        }
+#if defined(UART_PRINTF_FLOAT) && (UART_PRINTF_FLOAT > 0)
+        case 'f':
+        case 'F':
+            count += uart_printfFloat(UART_BUFFER_ARG(uartBuffer) &spec, va_arg(args, double));
+            continue;
+#else
+        case 'f':
+        case 'F':
+#endif
+        case 'e':
+        case 'E':
+        case 'g':
+        case 'G':
+        case 'a':
+        case 'A':
+            // Unsupported floating point conversion: its argument is skipped and the conversion written as is
+            (void)va_arg(args, double);
+            uart_write(UART_BUFFER_ARG(uartBuffer) (void *)start, (size_t)(format - start));
+            count += (size_t)(format - start);
+            continue;
+        case '%':
+            uart_write(UART_BUFFER_ARG(uartBuffer) (void *)"%", 1);
+            count++;
+            continue;
+        default:
+            // Unsupported conversion is written as is
+            if (conversion == '\0')
+                format--;
+            uart_write(UART_BUFFER_ARG(uartBuffer) (void *)start, (size_t)(format - start));
+            count += (size_t)(format - start);
+            continue;
+        }
+
+        // Integer conversions: precision sets the minimum digit quantity and disables '0' padding
+        size_t zeros = 0;
+        if (spec.precision >= 0)
+        {
+            spec.flags &= (uint8_t)~UART_PRINTF_ZERO;
+            if ((size_t)spec.precision > len)
+                zeros = (size_t)spec.precision - len;
+        }
+        count += uart_printfField(UART_BUFFER_ARG(uartBuffer) &spec, prefix, prefixLen, zeros, end - len, len, 0);
+    }
+    return (int)count;
+}
+
+int uart_printf(UART_BUFFER_PARAM const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    int count = uart_vprintf(UART_BUFFER_ARG(uartBuffer) format, args);
+    va_end(args);
+    return count;
+}
+
+int uart_printFixed(UART_BUFFER_PARAM int32_t value, uint8_t fracBits, uint8_t decimals)
+{
+    UARTPrintfSpec spec = {0, 0, -1};
+    uint32_t magnitude = (value < 0) ? (uint32_t)0 - (uint32_t)value : (uint32_t)value;
+    if (fracBits > 31)
+        fracBits = 31;
+    if (decimals > UART_PRINTF_MAX_PRECISION)
+        decimals = UART_PRINTF_MAX_PRECISION;
+    uint32_t integer = magnitude >> fracBits;
+    uint64_t fraction = (uint64_t)(magnitude & ((1UL << fracBits) - 1)) * uart_printfPow10[decimals];
+    if (fracBits != 0)
+        fraction = (fraction + (1ULL << (fracBits - 1))) >> fracBits;
+    if (fraction >= uart_printfPow10[decimals])
+    {
+        fraction -= uart_printfPow10[decimals];
+        integer++;
+    }
+    return (int)uart_printfDecimalFixed(UART_BUFFER_ARG(uartBuffer) &spec, value < 0, integer, (uint32_t)fraction, decimals, 0);
+}
@@ -0,0 +1,93 @@
+/**
+ * @file uart_printf.h
+ * @author Roberto Parra (uedsoldier1990@gmail.com)
+ * @brief printf-style formatted output written straight to the UART buffer TX path
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef UART_PRINTF_H
+#define UART_PRINTF_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#pragma region Dependencies
+#include <stdarg.h>
+#include "uart_buffer.h"
+#pragma endregion
+
+/**
+ * @brief Set this macro to zero to leave out %f support (no floating point code is linked). Fractional
+ * values can still be printed from fixed-point integers with uart_printFixed
+ */
+#ifndef UART_PRINTF_FLOAT
+#define UART_PRINTF_FLOAT 1
+#endif
+
+/**
+ * @brief Largest %f precision converted. Fractions are converted as integers scaled by 10^precision, so
+ * with a larger precision the first UART_PRINTF_MAX_PRECISION digits are truncated (not rounded) and the
+ * rest are filled with zeros: "%.12f" of 5e-10 gives 0.000000000000
+ */
+#define UART_PRINTF_MAX_PRECISION 9
+
+/*
+ * Lets the compiler check format strings against arguments
+ */
+#if defined(__GNUC__) || defined(__clang__)
+#if defined(UART_MULTIPLE_BUFFERS) && (UART_MULTIPLE_BUFFERS > 0)
+#define UART_PRINTF_CHECK __attribute__((format(printf, 2, 3)))
+#else
+#define UART_PRINTF_CHECK __attribute__((format(printf, 1, 2)))
+#endif
+#else
+#define UART_PRINTF_CHECK
+#endif
+
+#pragma region Function prototypes
+
+/**
+ * @brief Formatted output. Literal text is written straight from the format string and every conversion
+ * from a small stack array, so there is no intermediate line buffer. Supports flags '-', '0', '+', ' ', '#',
+ * width and precision (also '*'), length modifiers hh, h, l, ll, z, j and t, and conversions d, i, u, o, x,
+ * X, p, c, s, % and f (UART_PRINTF_FLOAT, |value| < 2^64, truncated to UART_PRINTF_MAX_PRECISION digits
+ * and zero filled past them). e, g and a conversions are written as is (their argument is skipped)
+ * @param uartBuffer Reference to UART buffer (parameter only present with UART_MULTIPLE_BUFFERS)
+ * @param format Format string
+ * @return int Written character quantity
+ */
+int uart_printf(UART_BUFFER_PARAM const char *format, ...) UART_PRINTF_CHECK;
+
+/**
+ * @brief Formatted output, va_list version of uart_printf
+ * @param uartBuffer Reference to UART buffer (parameter only present with UART_MULTIPLE_BUFFERS)
+ * @param format Format string
+ * @param args Argument list
+ * @return int Written character quantity
+ */
+int uart_vprintf(UART_BUFFER_PARAM const char *format, va_list args);
+
+/**
+ * @brief Prints a signed binary fixed-point value (e.g. Q16.16 with fracBits = 16) in decimal, rounded to
+ * 'decimals' fractional digits, using integer arithmetic only
+ * @param uartBuffer Reference to UART buffer (parameter only present with UART_MULTIPLE_BUFFERS)
+ * @param value Fixed-point value
+ * @param fracBits Fractional bit quantity (0 to 31)
+ * @param decimals Fractional decimal digits (0 to UART_PRINTF_MAX_PRECISION)
+ * @return int Written character quantity
+ */
+int uart_printFixed(UART_BUFFER_PARAM int32_t value, uint8_t fracBits, uint8_t decimals);
+
+#pragma endregion
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*UART_PRINTF_H*/
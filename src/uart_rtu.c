@@ -0,0 +1,119 @@
+/**
+ * @file uart_rtu.c
+ * @author Roberto Parra (uedsoldier1990@gmail.com)
+ * @brief
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include <string.h>
+#include "uart_rtu.h"
+
+/**
+ * @brief Ends current frame
+ * @return size_t Frame length without CRC if valid, 0 otherwise
+ */
+static size_t uart_rtuComplete(UARTRtuFramer *framer)
+{
+    size_t len = framer->len;
+    bool overflow = framer->overflow;
+    bool valid = uart_crcValue(&framer->crc) == 0;
+    framer->len = 0;
+    framer->overflow = false;
+    uart_crcReset(&framer->crc);
+    if (overflow)
+    {
+        framer->overflows++;
+        return 0;
+    }
+    if (len < UART_RTU_MIN_FRAME || !valid)
+    {
+        framer->crcErrors++;
+        return 0;
+    }
+    return len - 2;
+}
+
+/**
+ * @brief Appends received bytes to current frame up to the first gap
+ * @param data Received bytes
+ * @param stamps Their arrival times
+ * @param len Byte quantity
+ * @param frameLen Reference to store the length of a frame ended by a gap (0 if none)
+ * @return size_t Bytes processed (the byte after the gap isn't)
+ */
+static size_t uart_rtuFeed(UARTRtuFramer *framer, const uint8_t *data, const uint32_t *stamps, size_t len, size_t *frameLen)
+{
+    size_t count = 0;
+    *frameLen = 0;
+    while (count != len)
+    {
+        if (framer->len != 0 && stamps[count] - framer->last >= framer->gap)
+            break;
+        framer->last = stamps[count];
+        count++;
+        framer->len++;
+    }
+    // Bytes of the same frame are copied and checked as one run
+    size_t start = framer->len - count;
+    if (!framer->overflow && framer->len <= framer->size)
+    {
+        memcpy(framer->frame + start, data, count);
+        uart_crcUpdate(&framer->crc, data, count);
+    }
+    else if (!framer->overflow)
+    {
+        framer->overflow = true;
+    }
+    if (count != len && framer->len != 0)
+        *frameLen = uart_rtuComplete(framer);
+    return count;
+}
+
+void uart_rtuInit(UARTRtuFramer *framer, uint8_t *frame, size_t size, uint32_t baudRate)
+{
+    framer->frame = frame;
+    framer->size = size;
+    framer->len = 0;
+    framer->gap = (baudRate > 19200 || baudRate == 0) ? 1750 : (uint32_t)((35ULL * UART_RTU_CHAR_BITS * 1000000ULL + 10ULL * baudRate - 1) / (10ULL * baudRate));
+    framer->last = 0;
+    framer->overflow = false;
+    uart_crcInit(&framer->crc, UART_CRC16_MODBUS);
+    framer->crcErrors = 0;
+    framer->overflows = 0;
+}
+
+size_t uart_rtuRead(UART_BUFFER_PARAM UARTRtuFramer *framer)
+{
+    UARTSpan spans[2];
+    size_t frameLen = 0;
+    if (UART_BUFFER_SELF->rxStamps == NULL || UART_BUFFER_SELF->rxStampNow == NULL)
+        return 0;   // uart_setRxTimestamps wasn't called on this buffer
+    while (uart_peek(UART_BUFFER_ARG(uartBuffer) spans) != 0)
+    {
+        const uint32_t *stamps = UART_BUFFER_SELF->rxStamps + (spans[0].data - UART_BUFFER_SELF->rxBuffer);
+        size_t used = uart_rtuFeed(framer, spans[0].data, stamps, spans[0].len, &frameLen);
+        if (used == spans[0].len && spans[1].len != 0)
+            used += uart_rtuFeed(framer, spans[1].data, UART_BUFFER_SELF->rxStamps, spans[1].len, &frameLen);
+        uart_consume(UART_BUFFER_ARG(uartBuffer) used);
+        if (frameLen != 0)
+            return frameLen;
+        if (used == spans[0].len + spans[1].len)
+            break;
+    }
+    // Last frame received: it ends once the line has been silent for the gap
+    if (framer->len != 0 && UART_BUFFER_SELF->rxStampNow() - framer->last >= framer->gap)
+        return uart_rtuComplete(framer);
+    return 0;
+}
+
+void uart_rtuWrite(UART_BUFFER_PARAM const uint8_t *data, size_t len)
+{
+    uint16_t crc = (uint16_t)uart_crcCompute(UART_CRC16_MODBUS, data, len);
+    uint8_t tail[2] = {(uint8_t)crc, (uint8_t)(crc >> 8)};
+    uart_writeBuffer(UART_BUFFER_ARG(uartBuffer) (uint8_t *)data, len);
+    uart_writeBuffer(UART_BUFFER_ARG(uartBuffer) tail, 2);
+}
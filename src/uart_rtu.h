@@ -0,0 +1,96 @@
+/**
+ * @file uart_rtu.h
+ * @author Roberto Parra (uedsoldier1990@gmail.com)
+ * @brief Modbus RTU framing by inter-character gap on top of timestamped UART buffer reception
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef UART_RTU_H
+#define UART_RTU_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#pragma region Dependencies
+#include "uart_buffer.h"
+#include "uart_crc.h"
+#pragma endregion
+
+#if !(defined(UART_BUFFER_TIMESTAMP) && (UART_BUFFER_TIMESTAMP > 0))
+#error "uart_rtu needs UART_BUFFER_TIMESTAMP: frames are delimited by the arrival time of their bytes"
+#endif
+
+/**
+ * @brief Bits per RTU character: start, 8 data, parity (or second stop) and stop
+ */
+#define UART_RTU_CHAR_BITS 11
+
+/**
+ * @brief Largest RTU frame: address, PDU (up to 253 bytes) and CRC
+ */
+#define UART_RTU_MAX_FRAME 256
+
+/**
+ * @brief Minimum frame: address, function code and CRC
+ */
+#define UART_RTU_MIN_FRAME 4
+
+/**
+ * @brief Frame decoder state. Decoded frames are written straight into caller-owned storage
+ */
+typedef struct _UARTRtuFramer{
+    uint8_t *frame;         // Caller-owned storage for the frame being received
+    size_t size;            // Storage size in bytes
+    size_t len;             // Received bytes of current frame (CRC included)
+    uint32_t gap;           // Silent interval delimiting frames (t3.5), in microseconds
+    uint32_t last;          // Arrival time of the last byte of current frame
+    bool overflow;          // Current frame doesn't fit in storage and will be discarded
+    UARTCrc crc;            // Updated as bytes are appended: a valid frame leaves it at 0
+    uint32_t crcErrors;     // Frames discarded by CRC (or too short)
+    uint32_t overflows;     // Frames discarded by length
+} UARTRtuFramer;
+
+#pragma region Function prototypes
+
+/**
+ * @brief Frame decoder initialization. The silent interval is 3.5 characters, or 1750 us above 19200 bps
+ * @param framer Reference to frame decoder
+ * @param frame Reference to frame storage (UART_RTU_MAX_FRAME bytes for any frame)
+ * @param size Size of frame storage in bytes
+ * @param baudRate Line speed in bps
+ */
+void uart_rtuInit(UARTRtuFramer *framer, uint8_t *frame, size_t size, uint32_t baudRate);
+
+/**
+ * @brief Non-blocking frame reception. Slices received data into frames by the gaps between their
+ * timestamps, copying each byte once into the framer storage (CRC is updated on the way), and removes
+ * it from UART buffer. The last frame ends once the gap has elapsed since its last byte, measured
+ * with the UART buffer timestamp clock
+ * @param uartBuffer Reference to UART buffer with timestamps enabled (parameter only present with UART_MULTIPLE_BUFFERS)
+ * @param framer Reference to frame decoder
+ * @return size_t Length of a validated frame in framer->frame (address and PDU, CRC excluded), or 0 if none
+ * is complete yet (or the buffer has no timestamps). Frames with wrong CRC or length are discarded and counted
+ */
+size_t uart_rtuRead(UART_BUFFER_PARAM UARTRtuFramer *framer);
+
+/**
+ * @brief Sends a frame, appending its CRC
+ * @param uartBuffer Reference to UART buffer (parameter only present with UART_MULTIPLE_BUFFERS)
+ * @param data Address and PDU
+ * @param len Address and PDU length
+ */
+void uart_rtuWrite(UART_BUFFER_PARAM const uint8_t *data, size_t len);
+
+#pragma endregion
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*UART_RTU_H*/
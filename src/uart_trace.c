@@ -0,0 +1,123 @@
+/**
+ * @file uart_trace.c
+ * @author Roberto Parra (uedsoldier1990@gmail.com)
+ * @brief
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include <stdio.h>
+#include "uart_trace.h"
+
+/*
+ * Slot claim, an atomic fetch-and-add with GNU builtins or C11 atomics. Without atomics support it's a
+ * plain increment, only safe if writers can't preempt each other (e.g. the reader masks the UART
+ * interrupts while reading)
+ */
+#if defined(__GNUC__) || defined(__clang__)
+#define UART_TRACE_CLAIM(index) __atomic_fetch_add(&(index), 1, __ATOMIC_RELAXED)
+#define UART_TRACE_LOAD_HEAD(index) UART_LOAD_ACQUIRE(index)
+#define UART_TRACE_WRITE_FENCE() __atomic_thread_fence(__ATOMIC_RELEASE)
+#define UART_TRACE_READ_FENCE() __atomic_thread_fence(__ATOMIC_ACQUIRE)
+#elif defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 201112L) && !defined(__STDC_NO_ATOMICS__)
+#define UART_TRACE_CLAIM(index) atomic_fetch_add_explicit(&(index), 1, memory_order_relaxed)
+#define UART_TRACE_LOAD_HEAD(index) atomic_load_explicit(&(index), memory_order_acquire)
+#define UART_TRACE_WRITE_FENCE() atomic_thread_fence(memory_order_release)
+#define UART_TRACE_READ_FENCE() atomic_thread_fence(memory_order_acquire)
+#else
+#define UART_TRACE_CLAIM(index) ((index)++)
+#define UART_TRACE_LOAD_HEAD(index) (index)
+#define UART_TRACE_WRITE_FENCE() ((void)0)
+#define UART_TRACE_READ_FENCE() ((void)0)
+#endif
+
+static const char *const uart_traceNames[UART_TRACE_EVENT_MAX] = {
+    "rx", "read", "overrun", "drop", "flush", "tx"
+};
+
+bool uart_traceInit(UARTTrace *trace, UARTTraceSlot *slots, size_t size, uint32_t (*timeNow_callback)(void))
+{
+    if (size < 2 || size > UART_MAX_CAPACITY || (size & (size - 1)) != 0)
+        return false;
+    // A slot holds the record of position 'pos' once its sequence number is pos + 1
+    for (size_t i = 0; i != size; i++)
+    {
+        slots[i].seq = (uart_index_t)i;
+    }
+    trace->slots = slots;
+    trace->size = (uart_index_t)size;
+    trace->mask = (uart_index_t)(size - 1);
+    trace->head = 0;
+    trace->tail = 0;
+    trace->timeNow = timeNow_callback;
+    trace->lost = 0;
+    return true;
+}
+
+void uart_traceRecord(UARTTrace *trace, uint8_t port, uint8_t event, size_t value)
+{
+    uart_index_t pos = (uart_index_t)UART_TRACE_CLAIM(trace->head);
+    UARTTraceSlot *slot = &trace->slots[pos & trace->mask];
+    // Seqlock style: the slot is marked as being rewritten before its record changes
+    UART_STORE_RELEASE(slot->seq, pos);
+    UART_TRACE_WRITE_FENCE();
+    slot->record.time = (trace->timeNow != NULL) ? trace->timeNow() : 0;
+    slot->record.value = (value > 0xFFFF) ? 0xFFFF : (uint16_t)value;
+    slot->record.event = event;
+    slot->record.port = port;
+    UART_STORE_RELEASE(slot->seq, (uart_index_t)(pos + 1));
+}
+
+size_t uart_traceRead(UARTTrace *trace, UARTTraceRecord *records, size_t max)
+{
+    size_t count = 0;
+    while (count != max)
+    {
+        uart_index_t head = UART_TRACE_LOAD_HEAD(trace->head);
+        if ((uart_index_t)(head - trace->tail) > trace->size)
+        {
+            // Writers lapped the reader: skip to the oldest record still in the ring
+            uart_index_t oldest = (uart_index_t)(head - trace->size);
+            trace->lost += (uint32_t)(uart_index_t)(oldest - trace->tail);
+            trace->tail = oldest;
+        }
+        UARTTraceSlot *slot = &trace->slots[trace->tail & trace->mask];
+        uart_index_t seq = UART_LOAD_ACQUIRE(slot->seq);
+        if (seq != (uart_index_t)(trace->tail + 1))
+            break;      // Not written yet (or being rewritten by a newer lap)
+        records[count] = slot->record;
+        UART_TRACE_READ_FENCE();
+        if (UART_LOAD_ACQUIRE(slot->seq) != seq)
+            continue;   // Rewritten while copying: writers are a lap ahead, skipped above
+        count++;
+        trace->tail++;
+    }
+    return count;
+}
+
+size_t uart_tracePrint(UARTTrace *trace)
+{
+    UARTTraceRecord records[16];
+    size_t total = 0;
+    size_t count;
+    uint32_t lost = trace->lost;
+    while ((count = uart_traceRead(trace, records, sizeof(records) / sizeof(records[0]))) != 0)
+    {
+        if (trace->lost != lost)
+        {
+            printf("%s: %lu trace records lost\n", UART_BUFFER_TAG, (unsigned long)(trace->lost - lost));
+            lost = trace->lost;
+        }
+        for (size_t i = 0; i != count; i++)
+        {
+            const UARTTraceRecord *record = &records[i];
+            const char *name = (record->event < UART_TRACE_EVENT_MAX) ? uart_traceNames[record->event] : "?";
+            printf("%s: %10lu port %u %-7s %u\n", UART_BUFFER_TAG, (unsigned long)record->time, (unsigned)record->port, name, (unsigned)record->value);
+        }
+        total += count;
+    }
+    return total;
+}
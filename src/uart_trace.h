@@ -0,0 +1,126 @@
+/**
+ * @file uart_trace.h
+ * @author Roberto Parra (uedsoldier1990@gmail.com)
+ * @brief Deferred binary event trace of UART buffer activity
+ * @version 0.1
+ * @date 2026-10-16
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef UART_TRACE_H
+#define UART_TRACE_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#pragma region Dependencies
+#include "uart_buffer.h"
+#pragma endregion
+
+/**
+ * @brief Traced events. The record value is the byte quantity involved
+ */
+typedef enum _UART_TraceEvent{
+    UART_TRACE_RX = 0,      // Received data published by a reception handler
+    UART_TRACE_READ,        // Data removed by the reader
+    UART_TRACE_OVERRUN,     // Oldest data overwritten (overwrite policy), detected by the reader
+    UART_TRACE_DROP,        // Newest data dropped (drop newest/backpressure policies)
+    UART_TRACE_FLUSH,       // Data discarded by uart_flushBuffer/uart_hardFlushBuffer
+    UART_TRACE_TX,          // Data queued for transmission
+    UART_TRACE_EVENT_MAX
+} UART_TraceEvent;
+
+/**
+ * @brief Trace record, 8 bytes
+ */
+typedef struct _UARTTraceRecord{
+    uint32_t time;          // Microsecond clock, 0 without timeNow
+    uint16_t value;         // Byte quantity (saturated)
+    uint8_t event;          // UART_TraceEvent
+    uint8_t port;           // Port number given to uart_setTrace
+} UARTTraceRecord;
+
+/**
+ * @brief Trace ring slot. 'seq' tells the reader which lap the record belongs to
+ */
+typedef struct _UARTTraceSlot{
+    volatile uart_index_t seq;
+    UARTTraceRecord record;
+} UARTTraceSlot;
+
+/*
+ * Writer claim counter. Without GNU builtins but with C11 atomics it's an _Atomic, so that each claim is
+ * a single atomic read-modify-write
+ */
+#if !defined(__GNUC__) && !defined(__clang__) && defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 201112L) && !defined(__STDC_NO_ATOMICS__)
+typedef _Atomic uart_index_t uart_trace_index_t;
+#else
+typedef volatile uart_index_t uart_trace_index_t;
+#endif
+
+/*
+ * Writers (reception/transmission handlers and reader functions, from any context) claim a slot with an
+ * atomic increment of 'head', fill it and publish it by storing its sequence number. Nothing is formatted
+ * and nobody waits: when the reader falls behind, the oldest records are overwritten and counted as lost,
+ * like received data under overwrite policy. Records are read in bulk from a background task, to be
+ * printed (uart_tracePrint) or sent raw to a host.
+ */
+typedef struct _UARTTrace{
+    UARTTraceSlot *slots;       // Caller-owned ring storage
+    uart_index_t size;          // Slot quantity (power of two)
+    uart_index_t mask;          // size - 1
+    uart_trace_index_t head;    // Next slot to be claimed by a writer
+    uart_index_t tail;          // Next slot to be read
+    uint32_t (*timeNow)(void);  // Free-running microsecond clock (NULL: records aren't timestamped)
+    uint32_t lost;              // Records overwritten before being read
+} UARTTrace;
+
+#pragma region Function prototypes
+
+/**
+ * @brief Trace initialization. Attach it to one or more UART buffers with uart_setTrace (needs UART_BUFFER_LOG)
+ * @param trace Reference to trace state
+ * @param slots Reference to slot storage
+ * @param size Slot quantity (power of two, at least 2)
+ * @param timeNow_callback Reference to microsecond clock function, called from interrupt context (can be NULL)
+ * @return true Trace ready
+ * @return false Invalid slot quantity
+ */
+bool uart_traceInit(UARTTrace *trace, UARTTraceSlot *slots, size_t size, uint32_t (*timeNow_callback)(void));
+
+/**
+ * @brief Appends a record. ISR safe, lock free and wait free (called by UART buffer functions)
+ * @param trace Reference to trace state
+ * @param port Port number
+ * @param event UART_TraceEvent
+ * @param value Byte quantity
+ */
+void uart_traceRecord(UARTTrace *trace, uint8_t port, uint8_t event, size_t value);
+
+/**
+ * @brief Moves pending records out of the trace, oldest first (single reader)
+ * @param trace Reference to trace state
+ * @param records Reference to array to store records
+ * @param max Array length
+ * @return size_t Records read
+ */
+size_t uart_traceRead(UARTTrace *trace, UARTTraceRecord *records, size_t max);
+
+/**
+ * @brief Prints pending records through std output, one line each (background task or host side)
+ * @param trace Reference to trace state
+ * @return size_t Records printed
+ */
+size_t uart_tracePrint(UARTTrace *trace);
+
+#pragma endregion
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*UART_TRACE_H*/
@@ -0,0 +1,129 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../src/uart_buffer.h"
+#include "../src/uart_at.h"
+
+/*
+ * AT matcher test: a modem transcript (command echoes, responses with arguments, URCs, a data prompt and
+ * response words inside other lines) is fed into a small ring in random chunks, so matches are split across
+ * ring wrap and partial arrivals. Every response and URC must be reported once, in order, with its argument.
+ */
+
+#define AT_RING     32
+
+enum {AT_OK, AT_ERROR, AT_CME_ERROR, AT_PROMPT, AT_CMTI, AT_RING_URC, AT_CREG, AT_CSQ};
+
+static const char *transcript =
+    "AT\r\r\nOK\r\n"
+    "AT+CSQ\r\r\n+CSQ: 23,99\r\n\r\nOK\r\n"
+    "\r\n+CMTI: \"SM\",3\r\n"
+    "AT+CMGR=3\r\r\n+CMGR: \"REC UNREAD\"\r\nOK then ERROR inside a message\r\n\r\nOK\r\n"
+    "\r\nRING\r\n\r\nRING\r\n"
+    "AT+CPIN?\r\r\n+CME ERROR: 10\r\n"
+    "\r\n+CREG: 1,\"00C3\",\"0F12\"\r\n"
+    "AT+CMGS=\"123\"\r\r\n> hello\x1A\r\n+CMGS: 4\r\n\r\nOK\r\n"
+    "AT+BAD\r\r\nERROR\r\n";
+
+static const char *expected[] = {
+    "response 0 \"\"", "urc 7 \" 23,99\"", "response 0 \"\"", "urc 4 \" \"SM\",3\"", "response 0 \"\"",
+    "urc 5 \"\"", "urc 5 \"\"", "response 2 \" 10\"", "urc 6 \" 1,\"00C3\",\"0F12\"\"", "response 3 \"\"",
+    "response 0 \"\"", "response 1 \"\"",
+};
+
+static char events[16][96];
+static size_t eventCount = 0;
+static UARTBuffer port;
+static uint8_t rx_storage[AT_RING];
+static uint8_t tx_storage[AT_RING];
+
+static void urc_cb(void *context, uint8_t pattern, const char *argument, size_t len)
+{
+    (void)context;
+    if (eventCount != 16)
+        snprintf(events[eventCount++], sizeof(events[0]), "urc %u \"%.*s\"", (unsigned)pattern, (int)len, argument);
+}
+
+static const UARTAtPattern patterns[] = {
+    [AT_OK] = {"OK\r\n", false, NULL},
+    [AT_ERROR] = {"ERROR\r\n", false, NULL},
+    [AT_CME_ERROR] = {"+CME ERROR:", true, NULL},
+    [AT_PROMPT] = {"> ", false, NULL},
+    [AT_CMTI] = {"+CMTI:", true, urc_cb},
+    [AT_RING_URC] = {"RING\r\n", false, urc_cb},
+    [AT_CREG] = {"+CREG:", true, urc_cb},
+    [AT_CSQ] = {"+CSQ:", true, urc_cb},
+};
+
+void write_cb(uint8_t data)
+{
+    (void)data;
+}
+
+uint8_t read_cb()
+{
+    return 0;
+}
+
+int main(int argc, char const *argv[])
+{
+    (void)argc;
+    (void)argv;
+    static UARTAtMatcher matcher;
+    unsigned seed = 7;
+    int failures = 0;
+
+    if (!uart_atInit(&matcher, patterns, sizeof(patterns) / sizeof(patterns[0]), NULL))
+    {
+        printf("at: automaton doesn't fit\n");
+        return EXIT_FAILURE;
+    }
+    for (int run = 0; run != 50; run++)
+    {
+        const char *source = transcript;
+        size_t left = strlen(transcript);
+        eventCount = 0;
+        uart_buffer_initStorage(&port, rx_storage, AT_RING, tx_storage, AT_RING, write_cb, read_cb);
+        uart_atReset(&matcher);
+        while (left != 0 || uart_dataAvailable(&port) != 0)
+        {
+            // Random chunk as a DMA transfer would deliver it
+            UARTSpan spans[2];
+            seed = seed * 1103515245u + 12345u;
+            size_t chunk = (seed >> 16) % 9;
+            size_t space = uart_rxReserve(&port, spans);
+            if (chunk > left)
+                chunk = left;
+            if (chunk > space)
+                chunk = space;
+            size_t first = (chunk < spans[0].len) ? chunk : spans[0].len;
+            memcpy(spans[0].data, source, first);
+            memcpy(spans[1].data, source + first, chunk - first);
+            uart_rxCommit(&port, chunk);
+            source += chunk;
+            left -= chunk;
+
+            int response;
+            while ((response = uart_atRead(&port, &matcher)) != UART_AT_NONE)
+            {
+                if (eventCount != 16)
+                    snprintf(events[eventCount++], sizeof(events[0]), "response %d \"%s\"", response, matcher.argument);
+            }
+        }
+        size_t count = sizeof(expected) / sizeof(expected[0]);
+        for (size_t i = 0; i != count || i != eventCount; i++)
+        {
+            const char *got = (i < eventCount) ? events[i] : "(none)";
+            const char *want = (i < count) ? expected[i] : "(none)";
+            if (strcmp(got, want) != 0)
+            {
+                printf("at: run %d event %zu: got %s, expected %s\n", run, i, got, want);
+                failures++;
+                break;
+            }
+        }
+    }
+    printf("at: %s\n", failures == 0 ? "ok" : "FAILED");
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,347 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_CYCLES() __rdtsc()
+#endif
+#include "../src/uart_buffer.h"
+#include "bench_legacy.h"
+
+/*
+ * Queue benchmark: every scenario moves BENCH_BYTES through rings of several sizes, in rounds that fill
+ * the ring and drain it. Only the measured side of each round is timed. After BENCH_WARMUP unmeasured
+ * runs, BENCH_REPEATS runs are taken and the best and median ns/byte are reported, one key=value line
+ * per scenario and ring size, so results can be diffed or parsed between revisions. Where a cycle
+ * counter is available (x86 TSC) the best run is also reported in reference cycles per byte.
+ *
+ * The legacy_* scenarios run a copy of the original queueFront/queueEnd ring (signed indexes compared
+ * and wrapped on every access, byte-wise readBuffer) so the lock-free ring can be compared against it.
+ * It's built in its own translation unit (bench_legacy.c), so both are called the same way.
+ */
+
+#define BENCH_BYTES     (4UL * 1024UL * 1024UL)
+#define BENCH_WARMUP    2
+#define BENCH_REPEATS   7
+#define BENCH_LINE      32      // Line length (including LF) for uart_gets scenario
+#define BENCH_PATTERN   4096
+#define BENCH_PORT_SIZE 1024    // Ring size of the compile-time specialized port scenarios (fits UART_RX_BUFFER_SIZE)
+
+static const size_t bench_sizes[] = {64, 256, 1024, 4096, 65536};
+
+typedef double (*BenchRound)(size_t len);
+
+UARTBuffer rx;
+static uint8_t rx_storage[65536];
+static uint8_t tx_storage[65536];
+static uint8_t pattern[BENCH_PATTERN];
+static uint8_t sink[65536];
+static double cycles_per_ns = 0;    // Cycle counter rate, 0 if not available
+static size_t read_pos = 0;
+static volatile uint8_t last_written;
+
+void write_cb(uint8_t data)
+{
+    last_written = data;
+}
+
+uint8_t read_cb()
+{
+    return pattern[read_pos++ & (BENCH_PATTERN - 1)];
+}
+
+void tx_enable_cb(bool enable)
+{
+    (void)enable;
+}
+
+#define BENCH_PORTS(X) X(port, BENCH_PORT_SIZE, BENCH_PORT_SIZE, 115200, read_cb, write_cb, tx_enable_cb)
+BENCH_PORTS(UART_PORT_DECLARE)
+BENCH_PORTS(UART_PORT_DEFINE)
+
+static LegacyBuffer legacy = {.readByte = read_cb, .queueFront = -1, .queueEnd = -1};
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static void fill(size_t len)
+{
+    for (size_t i = 0; i != len; i++)
+    {
+        uart_interruptHandler(&rx);
+    }
+}
+
+static double round_isr_push(size_t len)
+{
+    double start = now_s();
+    fill(len);
+    double elapsed = now_s() - start;
+    uart_consume(&rx, len);
+    return elapsed;
+}
+
+static double round_read_byte(size_t len)
+{
+    uint8_t c;
+    fill(len);
+    double start = now_s();
+    for (size_t i = 0; i != len; i++)
+    {
+        uart_readByteBuffer(&rx, &c);
+    }
+    double elapsed = now_s() - start;
+    sink[0] = c;
+    return elapsed;
+}
+
+static double round_read_buffer(size_t len)
+{
+    fill(len);
+    double start = now_s();
+    uart_readBuffer(&rx, sink, len);
+    return now_s() - start;
+}
+
+static double round_gets(size_t len)
+{
+    char line[BENCH_LINE + 1];
+    fill(len);
+    double start = now_s();
+    for (size_t i = 0; i != len / BENCH_LINE; i++)
+    {
+        uart_gets(&rx, line, sizeof(line));
+    }
+    return now_s() - start;
+}
+
+static double round_port_isr_push(size_t len)
+{
+    double start = now_s();
+    for (size_t i = 0; i != len; i++)
+    {
+        port_interruptHandler();
+    }
+    double elapsed = now_s() - start;
+    uart_consume(&port, len);
+    return elapsed;
+}
+
+static double round_port_read_byte(size_t len)
+{
+    uint8_t c = 0;
+    for (size_t i = 0; i != len; i++)
+    {
+        port_interruptHandler();
+    }
+    double start = now_s();
+    while (port_readByte(&c))
+    {
+    }
+    double elapsed = now_s() - start;
+    sink[0] = c;
+    return elapsed;
+}
+
+static double round_legacy_isr_push(size_t len)
+{
+    double start = now_s();
+    for (size_t i = 0; i != len; i++)
+    {
+        legacy_interruptHandler(&legacy);
+    }
+    double elapsed = now_s() - start;
+    legacy.queueFront = legacy.queueEnd = -1;
+    return elapsed;
+}
+
+static double round_legacy_read_byte(size_t len)
+{
+    uint8_t c = 0;
+    for (size_t i = 0; i != len; i++)
+    {
+        legacy_interruptHandler(&legacy);
+    }
+    double start = now_s();
+    for (size_t i = 0; i != len; i++)
+    {
+        legacy_readByteBuffer(&legacy, &c);
+    }
+    double elapsed = now_s() - start;
+    sink[0] = c;
+    return elapsed;
+}
+
+static double round_legacy_read_buffer(size_t len)
+{
+    for (size_t i = 0; i != len; i++)
+    {
+        legacy_interruptHandler(&legacy);
+    }
+    double start = now_s();
+    legacy_readBuffer(&legacy, sink, len);
+    return now_s() - start;
+}
+
+static double round_available(size_t len)
+{
+    size_t total = 0;
+    fill(len);
+    double start = now_s();
+    for (size_t i = 0; i != len; i++)
+    {
+        total += uart_dataAvailable(&rx);
+    }
+    double elapsed = now_s() - start;
+    uart_consume(&rx, len);
+    sink[0] = (uint8_t)total;
+    return elapsed;
+}
+
+static double round_pop_byte(size_t len)
+{
+    uint8_t c = 0;
+    fill(len);
+    double start = now_s();
+    while (uart_popByte(&rx, &c))
+    {
+    }
+    double elapsed = now_s() - start;
+    sink[0] = c;
+    return elapsed;
+}
+
+static double round_write_sync(size_t len)
+{
+    double start = now_s();
+    uart_writeBuffer(&rx, sink, len);
+    return now_s() - start;
+}
+
+static double round_write_ring(size_t len)
+{
+    double start = now_s();
+    uart_writeBuffer(&rx, sink, len);
+    double elapsed = now_s() - start;
+    for (size_t i = 0; i != len + 1; i++)
+    {
+        uart_txInterruptHandler(&rx);
+    }
+    return elapsed;
+}
+
+static double round_tx_isr(size_t len)
+{
+    uart_writeBuffer(&rx, sink, len);
+    double start = now_s();
+    for (size_t i = 0; i != len + 1; i++)
+    {
+        uart_txInterruptHandler(&rx);
+    }
+    return now_s() - start;
+}
+
+/**
+ * @brief Measures cycle counter rate against the monotonic clock
+ */
+static void calibrate_cycles(void)
+{
+#ifdef BENCH_CYCLES
+    double start = now_s(), elapsed;
+    unsigned long long cycles = BENCH_CYCLES();
+    do
+    {
+        elapsed = now_s() - start;
+    } while (elapsed < 0.05);
+    cycles_per_ns = (double)(BENCH_CYCLES() - cycles) / (elapsed * 1e9);
+#endif
+}
+
+static int compare_double(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Runs a scenario on a ring of 'size' bytes and prints its results
+ */
+static void bench(const char *name, BenchRound round, size_t size, bool txRing)
+{
+    double runs[BENCH_REPEATS];
+    size_t len = size;
+
+    uart_buffer_initStorage(&rx, rx_storage, size, tx_storage, size, write_cb, read_cb);
+    if (txRing)
+        uart_txInit(&rx, tx_enable_cb, 115200);
+    if (round == round_gets)
+        len -= size % BENCH_LINE;
+    if (len == 0)
+        return;
+
+    for (int run = 0; run != BENCH_WARMUP + BENCH_REPEATS; run++)
+    {
+        double elapsed = 0;
+        read_pos = 0;
+        for (unsigned long done = 0; done < BENCH_BYTES; done += len)
+        {
+            elapsed += round(len);
+        }
+        if (run >= BENCH_WARMUP)
+            runs[run - BENCH_WARMUP] = elapsed;
+    }
+    qsort(runs, BENCH_REPEATS, sizeof(runs[0]), compare_double);
+
+    unsigned long bytes = ((BENCH_BYTES + len - 1) / len) * len;
+    double best = runs[0] * 1e9 / (double)bytes;
+    double median = runs[BENCH_REPEATS / 2] * 1e9 / (double)bytes;
+    printf("scenario=%s size=%lu bytes=%lu repeats=%d best_ns_per_byte=%.3f median_ns_per_byte=%.3f MBps=%.1f",
+           name, (unsigned long)size, bytes, BENCH_REPEATS, best, median, 1e3 / median);
+    if (cycles_per_ns > 0)
+        printf(" best_cycles_per_byte=%.2f", best * cycles_per_ns);
+    printf("\n");
+}
+
+int main(int argc, char const *argv[])
+{
+    (void)argc;
+    (void)argv;
+
+    for (size_t i = 0; i != BENCH_PATTERN; i++)
+    {
+        pattern[i] = (i % BENCH_LINE == BENCH_LINE - 1) ? '\n' : (uint8_t)('0' + i % 10);
+    }
+    memset(sink, 0x55, sizeof(sink));
+    calibrate_cycles();
+
+    for (size_t s = 0; s != sizeof(bench_sizes) / sizeof(bench_sizes[0]); s++)
+    {
+        bench("isr_push", round_isr_push, bench_sizes[s], false);
+        bench("read_byte", round_read_byte, bench_sizes[s], false);
+        bench("available", round_available, bench_sizes[s], false);
+        bench("pop_byte", round_pop_byte, bench_sizes[s], false);
+        bench("read_buffer", round_read_buffer, bench_sizes[s], false);
+        bench("gets", round_gets, bench_sizes[s], false);
+        bench("write_sync", round_write_sync, bench_sizes[s], false);
+        bench("write_ring", round_write_ring, bench_sizes[s], true);
+        bench("tx_isr", round_tx_isr, bench_sizes[s], true);
+        if (bench_sizes[s] == BENCH_LEGACY_SIZE)
+        {
+            bench("legacy_isr_push", round_legacy_isr_push, bench_sizes[s], false);
+            bench("legacy_read_byte", round_legacy_read_byte, bench_sizes[s], false);
+            bench("legacy_read_buffer", round_legacy_read_buffer, bench_sizes[s], false);
+        }
+        if (bench_sizes[s] == BENCH_PORT_SIZE)
+        {
+            bench("port_isr_push", round_port_isr_push, bench_sizes[s], false);
+            bench("port_read_byte", round_port_read_byte, bench_sizes[s], false);
+        }
+    }
+    return EXIT_SUCCESS;
+}
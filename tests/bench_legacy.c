@@ -0,0 +1,66 @@
+#include "bench_legacy.h"
+
+/*
+ * Original queueFront/queueEnd handler and readers, unchanged except for the ring size macro
+ */
+
+void legacy_interruptHandler(LegacyBuffer *uartBuffer)
+{
+    uint8_t data = uartBuffer->readByte();
+    if (((uartBuffer->queueEnd == BENCH_LEGACY_SIZE - 1) && uartBuffer->queueFront == 0) || ((uartBuffer->queueEnd + 1) == uartBuffer->queueFront))
+    {
+        uartBuffer->queueFront++;
+        if (uartBuffer->queueFront == BENCH_LEGACY_SIZE)
+            uartBuffer->queueFront = 0;
+    }
+
+    if (uartBuffer->queueEnd == BENCH_LEGACY_SIZE - 1)
+        uartBuffer->queueEnd = 0;
+    else
+        uartBuffer->queueEnd++;
+    uartBuffer->rxBuffer[uartBuffer->queueEnd] = data;
+
+    if (uartBuffer->queueFront == -1)
+        uartBuffer->queueFront = 0;
+}
+
+size_t legacy_dataAvailable(LegacyBuffer *uartBuffer)
+{
+    if (uartBuffer->queueFront == -1)
+        return 0;
+    else if (uartBuffer->queueFront < uartBuffer->queueEnd)
+        return (uartBuffer->queueEnd - uartBuffer->queueFront + 1);
+    else if (uartBuffer->queueFront > uartBuffer->queueEnd)
+        return (BENCH_LEGACY_SIZE - uartBuffer->queueFront + uartBuffer->queueEnd + 1);
+    else
+        return 1;
+}
+
+void legacy_readByteBuffer(LegacyBuffer *uartBuffer, uint8_t *byte)
+{
+    if (uartBuffer->queueFront == -1)
+        return;
+
+    *byte = uartBuffer->rxBuffer[uartBuffer->queueFront];
+
+    if (uartBuffer->queueFront == uartBuffer->queueEnd)
+    {
+        uartBuffer->queueFront = -1;
+        uartBuffer->queueEnd = -1;
+    }
+    else
+    {
+        uartBuffer->queueFront++;
+        if (uartBuffer->queueFront == BENCH_LEGACY_SIZE)
+            uartBuffer->queueFront = 0;
+    }
+}
+
+void legacy_readBuffer(LegacyBuffer *uartBuffer, uint8_t *buffer, size_t len)
+{
+    while (len--)
+    {
+        while (legacy_dataAvailable(uartBuffer) == 0);
+        legacy_readByteBuffer(uartBuffer, buffer++);
+    }
+}
@@ -0,0 +1,24 @@
+#ifndef BENCH_LEGACY_H
+#define BENCH_LEGACY_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define BENCH_LEGACY_SIZE 256   // Ring size of the original handler scenarios
+
+/*
+ * Original ring, as it was before the free-running index rework
+ */
+typedef struct _LegacyBuffer{
+    uint8_t (*readByte)(void);
+    uint8_t rxBuffer[BENCH_LEGACY_SIZE];
+    volatile int16_t queueFront;
+    volatile int16_t queueEnd;
+} LegacyBuffer;
+
+void legacy_interruptHandler(LegacyBuffer *uartBuffer);
+size_t legacy_dataAvailable(LegacyBuffer *uartBuffer);
+void legacy_readByteBuffer(LegacyBuffer *uartBuffer, uint8_t *byte);
+void legacy_readBuffer(LegacyBuffer *uartBuffer, uint8_t *buffer, size_t len);
+
+#endif
@@ -0,0 +1,148 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../src/uart_buffer.h"
+
+/*
+ * Reception events test: bytes are fed through uart_interruptHandler and uart_burstInterruptHandler, and
+ * the threshold, delimiter and idle events must fire exactly when expected, first straight from the
+ * handlers and then deferred to uart_dispatchRxEvents.
+ */
+
+#define EVENTS_RING 64
+
+static UARTBuffer port;
+static uint8_t rx_storage[EVENTS_RING];
+static uint8_t tx_storage[EVENTS_RING];
+static const char *source = NULL;
+static uint8_t fired = 0;       // Events received by the callback
+static unsigned calls = 0;      // Callback calls
+static unsigned deferred = 0;   // Defer hook calls
+static int failures = 0;
+
+void write_cb(uint8_t data)
+{
+    (void)data;
+}
+
+uint8_t read_cb()
+{
+    return (uint8_t)*source++;
+}
+
+static size_t read_bytes_cb(uint8_t *data, size_t max)
+{
+    size_t len = strlen(source);
+    if (len > max)
+        len = max;
+    memcpy(data, source, len);
+    source += len;
+    return len;
+}
+
+static void event_cb(void *context, uint8_t events)
+{
+    (void)context;
+    fired |= events;
+    calls++;
+}
+
+static void defer_cb(void *context)
+{
+    (void)context;
+    deferred++;
+}
+
+static void feed(const char *text)
+{
+    for (source = text; *source != '\0';)
+    {
+        uart_interruptHandler(&port);
+    }
+}
+
+static void expect(const char *step, uint8_t events)
+{
+    if (fired != events)
+    {
+        printf("events: %s: got 0x%02X, expected 0x%02X\n", step, fired, events);
+        failures++;
+    }
+    fired = 0;
+    calls = 0;
+}
+
+int main(int argc, char const *argv[])
+{
+    (void)argc;
+    (void)argv;
+    uint8_t discard[EVENTS_RING];
+
+    uart_buffer_initStorage(&port, rx_storage, EVENTS_RING, tx_storage, EVENTS_RING, write_cb, read_cb);
+    uart_rxBurstInit(&port, read_bytes_cb);
+    uart_setRxEvents(&port, 8, '\n', event_cb, NULL, NULL);
+
+    feed("abc");
+    expect("below threshold", 0);
+    uart_idleInterruptHandler(&port);
+    expect("idle after data", UART_RX_EVENT_IDLE);
+    uart_idleInterruptHandler(&port);
+    expect("idle without new data", 0);
+    feed("defgh");
+    expect("threshold crossed", UART_RX_EVENT_THRESHOLD);
+    feed("ij");
+    expect("above threshold", 0);
+    feed("k\n");
+    expect("delimiter", UART_RX_EVENT_DELIMITER);
+
+    // Draining below the threshold arms it again; a burst across the ring end crosses it and carries a delimiter
+    uart_readAvailable(&port, discard, sizeof(discard));
+    feed("0123456789012345678901234567890123456789012345");
+    fired = 0;
+    calls = 0;
+    uart_readAvailable(&port, discard, sizeof(discard));
+    source = "burst data\nwrapping";
+    uart_burstInterruptHandler(&port);
+    if (calls != 1)
+    {
+        printf("events: burst fired %u callbacks\n", calls);
+        failures++;
+    }
+    expect("burst", UART_RX_EVENT_THRESHOLD | UART_RX_EVENT_DELIMITER);
+
+    // Deferred: handlers only accumulate, the first pending event schedules a single dispatch
+    uart_readAvailable(&port, discard, sizeof(discard));
+    uart_setRxEvents(&port, 4, '\n', event_cb, defer_cb, NULL);
+    feed("ab\n");
+    feed("cdef");
+    uart_idleInterruptHandler(&port);
+    expect("deferred before dispatch", 0);
+    if (deferred != 1)
+    {
+        printf("events: defer hook called %u times\n", deferred);
+        failures++;
+    }
+    uint8_t dispatched = uart_dispatchRxEvents(&port);
+    if (dispatched != (UART_RX_EVENT_THRESHOLD | UART_RX_EVENT_DELIMITER | UART_RX_EVENT_IDLE) || calls != 1)
+    {
+        printf("events: dispatched 0x%02X in %u calls\n", dispatched, calls);
+        failures++;
+    }
+    expect("deferred dispatch", UART_RX_EVENT_THRESHOLD | UART_RX_EVENT_DELIMITER | UART_RX_EVENT_IDLE);
+    if (uart_dispatchRxEvents(&port) != 0)
+    {
+        printf("events: events dispatched twice\n");
+        failures++;
+    }
+    feed("\n");
+    if (deferred != 2 || uart_dispatchRxEvents(&port) != UART_RX_EVENT_DELIMITER)
+    {
+        printf("events: defer hook not called again after dispatch\n");
+        failures++;
+    }
+    expect("second dispatch", UART_RX_EVENT_DELIMITER);
+
+    printf("events: %s\n", failures == 0 ? "ok" : "FAILED");
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
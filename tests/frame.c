@@ -0,0 +1,200 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../src/uart_buffer.h"
+#include "../src/uart_frame.h"
+
+/*
+ * Frame layer test: frames are encoded with uart_frameWrite onto a simulated wire, received byte by
+ * byte into a small ring (so encoded data keeps crossing the wrap-around point) and decoded in place
+ * with uart_frameRead. COBS frames with long non-zero runs and zeros, SLIP frames full of END/ESC bytes,
+ * malformed frames and frames larger than the decoder storage are checked.
+ */
+
+#define FRAME_RING  64
+#define FRAME_SIZE  600     // Decoder storage: the largest frames below don't fit
+#define WIRE_SIZE   16384
+
+static UARTBuffer port;
+static uint8_t rx_storage[FRAME_RING];
+static uint8_t tx_storage[FRAME_RING];
+static uint8_t wire[WIRE_SIZE];
+static size_t wire_len = 0;
+static size_t wire_pos = 0;
+static size_t completed = 0;
+
+void write_cb(uint8_t data)
+{
+    if (wire_len != WIRE_SIZE)
+        wire[wire_len++] = data;
+}
+
+uint8_t read_cb()
+{
+    return wire[wire_pos++];
+}
+
+static void frame_complete_cb(const uint8_t *frame, size_t len, void *context)
+{
+    (void)frame;
+    (void)len;
+    (*(size_t *)context)++;
+}
+
+/**
+ * @brief Receives everything on the wire, a few bytes per interrupt burst, and decodes it
+ * @param decoder Reference to frame decoder
+ * @param frames Reference to store decoded frames back to back
+ * @param lens Reference to store decoded frame lengths
+ * @param max Max frame quantity
+ * @return size_t Decoded frame quantity
+ */
+static size_t receive(UARTFrameDecoder *decoder, uint8_t *frames, size_t *lens, size_t max)
+{
+    size_t count = 0, offset = 0;
+    while (wire_pos != wire_len || uart_dataAvailable(&port) != 0)
+    {
+        // Odd burst sizes, never overwriting unread bytes
+        size_t burst = 1 + (wire_pos * 7) % 23;
+        while (burst-- != 0 && wire_pos != wire_len && uart_dataAvailable(&port) != FRAME_RING)
+        {
+            uart_interruptHandler(&port);
+        }
+        size_t len;
+        while ((len = uart_frameRead(&port, decoder)) != 0)
+        {
+            if (count != max)
+            {
+                memcpy(frames + offset, decoder->frame, len);
+                lens[count++] = len;
+                offset += len;
+            }
+        }
+    }
+    wire_len = wire_pos = 0;
+    return count;
+}
+
+/**
+ * @brief Sends 'n' frames and checks that only those flagged in 'valid' come out, intact and in order
+ */
+static int round_trip(const char *name, UART_FrameType type, const uint8_t *const *data, const size_t *lens, const bool *valid, size_t n)
+{
+    static uint8_t storage[FRAME_SIZE];
+    static uint8_t decoded[WIRE_SIZE];
+    size_t decodedLens[16];
+    UARTFrameDecoder decoder;
+    int failures = 0;
+
+    completed = 0;
+    uart_frameDecoderInit(&decoder, type, storage, sizeof(storage), frame_complete_cb, &completed);
+    for (size_t i = 0; i != n; i++)
+    {
+        uart_frameWrite(&port, type, data[i], lens[i]);
+    }
+    size_t count = receive(&decoder, decoded, decodedLens, 16);
+
+    size_t expected = 0, offset = 0;
+    for (size_t i = 0; i != n; i++)
+    {
+        if (!valid[i])
+            continue;
+        if (expected >= count || decodedLens[expected] != lens[i] || memcmp(decoded + offset, data[i], lens[i]) != 0)
+        {
+            printf("%s: frame %zu (%zu bytes) not decoded intact\n", name, i, lens[i]);
+            failures++;
+            break;
+        }
+        offset += decodedLens[expected++];
+    }
+    if (failures == 0 && (count != expected || completed != expected))
+    {
+        printf("%s: %zu frames decoded (%zu callbacks), %zu expected\n", name, count, completed, expected);
+        failures++;
+    }
+    return failures;
+}
+
+/**
+ * @brief Sends raw (already encoded) bytes followed by a valid frame, which must be the only one decoded
+ */
+static int malformed(const char *name, UART_FrameType type, const uint8_t *raw, size_t rawLen)
+{
+    static const uint8_t good[] = {0x01, 0x02, 0x00, 0xC0, 0xDB, 0x03};
+    static uint8_t storage[FRAME_SIZE];
+    uint8_t decoded[sizeof(good)];
+    size_t len;
+    UARTFrameDecoder decoder;
+
+    uart_frameDecoderInit(&decoder, type, storage, sizeof(storage), NULL, NULL);
+    memcpy(wire, raw, rawLen);
+    wire_len = rawLen;
+    uart_frameWrite(&port, type, good, sizeof(good));
+    if (receive(&decoder, decoded, &len, 1) != 1 || len != sizeof(good) || memcmp(decoded, good, len) != 0)
+    {
+        printf("%s: malformed frame not discarded\n", name);
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char const *argv[])
+{
+    (void)argc;
+    (void)argv;
+    static uint8_t zeros[40];
+    static uint8_t run253[253], run254[254], run255[255], run508[508], mixed[520], oversized[700];
+    static uint8_t special[300];
+    const uint8_t empty = 0;
+    int failures = 0;
+
+    uart_buffer_initStorage(&port, rx_storage, FRAME_RING, tx_storage, FRAME_RING, write_cb, read_cb);
+
+    // COBS: runs around the 254 byte block limit, zeros everywhere, and a frame larger than the storage
+    memset(run253, 0x5A, sizeof(run253));
+    memset(run254, 0xA5, sizeof(run254));
+    memset(run255, 0x33, sizeof(run255));
+    for (size_t i = 0; i != sizeof(run508); i++)
+    {
+        run508[i] = (uint8_t)(1 + i % 255);
+    }
+    for (size_t i = 0; i != sizeof(mixed); i++)
+    {
+        mixed[i] = (i % 97 == 0 || i % 300 == 299) ? 0x00 : (uint8_t)(i * 13);
+    }
+    memset(oversized, 0x77, sizeof(oversized));
+    {
+        const uint8_t *data[] = {run253, run254, run255, zeros, oversized, run508, mixed, zeros};
+        const size_t lens[] = {sizeof(run253), sizeof(run254), sizeof(run255), sizeof(zeros), sizeof(oversized), sizeof(run508), sizeof(mixed), 1};
+        const bool valid[] = {true, true, true, true, false, true, true, true};
+        failures += round_trip("cobs", UART_FRAME_COBS, data, lens, valid, 8);
+    }
+
+    // SLIP: payloads made of END and ESC bytes (and of the bytes used to escape them)
+    for (size_t i = 0; i != sizeof(special); i++)
+    {
+        static const uint8_t bytes[] = {UART_SLIP_END, UART_SLIP_ESC, UART_SLIP_ESC_END, UART_SLIP_ESC_ESC, 0x00, 0x41};
+        special[i] = bytes[(i * 5 + i / 7) % sizeof(bytes)];
+    }
+    {
+        const uint8_t *data[] = {special, run255, oversized, special + 1, &empty};
+        const size_t lens[] = {sizeof(special), sizeof(run255), sizeof(oversized), 17, 1};
+        const bool valid[] = {true, true, false, true, true};
+        failures += round_trip("slip", UART_FRAME_SLIP, data, lens, valid, 5);
+    }
+
+    // Malformed COBS: the code byte announces more data than there is before the delimiter
+    {
+        static const uint8_t raw[] = {0x00, 0x00, 0x05, 0x11, 0x22, 0x00};
+        failures += malformed("cobs", UART_FRAME_COBS, raw, sizeof(raw));
+    }
+    // Malformed SLIP: frame ends right after an escape
+    {
+        static const uint8_t raw[] = {UART_SLIP_END, 0x11, 0x22, UART_SLIP_ESC, UART_SLIP_END};
+        failures += malformed("slip", UART_FRAME_SLIP, raw, sizeof(raw));
+    }
+
+    printf("frame: %s\n", failures == 0 ? "ok" : "FAILED");
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,391 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <errno.h>
+#include <semaphore.h>
+#include "../src/uart_buffer.h"
+
+/*
+ * Line simulation harness: a producer thread calls uart_interruptHandler at the exact byte times of a
+ * simulated baud rate, sending 10 byte lines that carry the arrival time of their own '\n'. A consumer
+ * drains the ring either by polling with uart_readBuffer every 'period' or with uart_getsTimeout, spending
+ * 'period' on every line. Each run reports lost bytes (UART buffer statistics), peak fill and line latency
+ * percentiles (from '\n' arrival to the consumer getting the line). For every traffic profile, baud rate
+ * and ring size the consumer period is searched by bisection, from twice the steady polling limit
+ * (ring * UART_FRAME_BITS / baud) doubled up to the run duration, and the safe operating region is
+ * printed: the longest period whose every repeated run lost nothing. Runs last at least four steady
+ * polling limits, so that the ring can overflow several times within one run. When permitted, both
+ * threads run SCHED_FIFO (the producer above the consumer); otherwise host scheduling stalls count as
+ * losses too, and on a loaded host a cell may come out lower (or '-') than the ring allows.
+ *
+ * Usage: linesim [run duration in ms, default 40] [repeats per period, default 3]
+ */
+
+#define SIM_LINE        10      // "%09lu\n"
+#define SIM_MAX_RING    1024
+
+typedef enum {
+    SIM_STEADY = 0,     // Back to back bytes
+    SIM_BURST,          // 16 lines back to back, then as long idle
+    SIM_JITTER,         // 0 to 3 idle characters before every line
+    SIM_PROFILES
+} SimProfile;
+
+typedef enum {
+    SIM_POLL = 0,       // Every period: uart_readBuffer of all available bytes
+    SIM_GETS,           // uart_getsTimeout, then 'period' of work per line
+    SIM_CONSUMERS
+} SimConsumer;
+
+static const char *const profile_names[SIM_PROFILES] = {"steady", "burst", "jitter"};
+static const char *const consumer_names[SIM_CONSUMERS] = {"readBuffer", "gets"};
+static const uint32_t bauds[] = {115200, 460800, 921600};
+static const size_t sizes[] = {64, 256, 1024};
+
+#define SIM_BAUDS   (sizeof(bauds) / sizeof(bauds[0]))
+#define SIM_SIZES   (sizeof(sizes) / sizeof(sizes[0]))
+#define SIM_MIN_PERIOD  20      // Shortest period tried (us)
+#define SIM_RESOLUTION  16      // Bisection stops when the unsafe and safe periods differ by 1/16 or less
+
+typedef struct {
+    uint32_t baud;
+    size_t size;
+    uint32_t period;        // Microseconds
+    SimProfile profile;
+    SimConsumer consumer;
+    uint64_t duration;      // Nanoseconds of simulated traffic
+} SimConfig;
+
+typedef struct {
+    unsigned long produced;
+    unsigned long lost;
+    unsigned long peak;
+    unsigned long lines;
+    unsigned long corrupted;    // Lines spliced by an overrun
+    uint32_t p50, p99, max;     // Line latency in microseconds
+} SimResult;
+
+static UARTBuffer port;
+static uint8_t rx_storage[SIM_MAX_RING];
+static uint8_t tx_storage[2];
+static const char *source;
+static uint64_t start_ns;
+static volatile int producer_done;
+static sem_t sem;
+static bool realtime = false;   // Threads run SCHED_FIFO, so host scheduling doesn't stall them
+
+void write_cb(uint8_t data)
+{
+    (void)data;
+}
+
+uint8_t read_cb()
+{
+    return (uint8_t)*source;
+}
+
+static uint64_t mono_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static uint32_t now_us(void)
+{
+    return (uint32_t)((mono_ns() - start_ns) / 1000ULL);
+}
+
+static void sleep_until(uint64_t deadline)
+{
+    struct timespec ts = {(time_t)(deadline / 1000000000ULL), (long)(deadline % 1000000000ULL)};
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR){}
+}
+
+static void rx_wait_cb(void *context, uint32_t timeout)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_sec += timeout / 1000000u;
+    ts.tv_nsec += (long)(timeout % 1000000u) * 1000L;
+    if (ts.tv_nsec >= 1000000000L)
+    {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000L;
+    }
+    sem_timedwait((sem_t *)context, &ts);
+}
+
+static void rx_wake_cb(void *context)
+{
+    int value;
+    if (sem_getvalue((sem_t *)context, &value) == 0 && value == 0)
+        sem_post((sem_t *)context);
+}
+
+static void *producer(void *arg)
+{
+    const SimConfig *config = (const SimConfig *)arg;
+    uint64_t char_ns = (uint64_t)UART_FRAME_BITS * 1000000000ULL / config->baud;
+    uint64_t t = start_ns;      // Arrival time of next byte
+    uint64_t end = start_ns + config->duration;
+    unsigned seed = 1;
+    unsigned long lines = 0;
+    char line[SIM_LINE + 1];
+
+    while (t < end)
+    {
+        if (config->profile == SIM_BURST && lines % 16 == 0 && lines != 0)
+            t += 16 * SIM_LINE * char_ns;
+        if (config->profile == SIM_JITTER)
+        {
+            seed = seed * 1103515245u + 12345u;
+            t += ((seed >> 16) % 4) * char_ns;
+        }
+        snprintf(line, sizeof(line), "%09lu\n", (unsigned long)((t + (SIM_LINE - 1) * char_ns - start_ns) / 1000ULL % 1000000000ULL));
+        lines++;
+        for (source = line; *source != '\0'; source++, t += char_ns)
+        {
+            // Bytes whose time has passed are delivered right away (a real ISR would fire for each one)
+            if (t > mono_ns())
+                sleep_until(t);
+            uart_interruptHandler(&port);
+        }
+    }
+    __atomic_store_n(&producer_done, 1, __ATOMIC_RELEASE);
+    sem_post(&sem);
+    return NULL;
+}
+
+/**
+ * @brief Checks a received line and records its latency
+ */
+static void line_received(const char *line, size_t len, uint32_t *latencies, SimResult *result)
+{
+    char *end;
+    if (len != SIM_LINE || line[SIM_LINE - 1] != '\n')
+    {
+        result->corrupted++;
+        return;
+    }
+    unsigned long arrival = strtoul(line, &end, 10);
+    if (end != line + SIM_LINE - 1)
+    {
+        result->corrupted++;
+        return;
+    }
+    latencies[result->lines++] = now_us() - (uint32_t)arrival;
+}
+
+static int latency_compare(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+static void sim_run(const SimConfig *config, SimResult *result)
+{
+    static uint8_t chunk[SIM_MAX_RING];
+    static char line[SIM_LINE + 1];
+    size_t max_lines = (size_t)(config->duration / 1000ULL * config->baud / UART_FRAME_BITS / 1000000ULL / SIM_LINE) + 16;
+    uint32_t *latencies = malloc(max_lines * sizeof(uint32_t));
+    size_t line_len = 0;
+    pthread_t thread;
+    UARTStats stats;
+
+    memset(result, 0, sizeof(*result));
+    uart_buffer_initStorage(&port, rx_storage, config->size, tx_storage, sizeof(tx_storage), write_cb, read_cb);
+    if (config->consumer == SIM_GETS)
+        uart_setWaitHooks(&port, now_us, rx_wait_cb, rx_wake_cb, &sem);
+    while (sem_trywait(&sem) == 0){}
+    producer_done = 0;
+    start_ns = mono_ns();
+    pthread_create(&thread, NULL, producer, (void *)config);
+    if (realtime)
+    {
+        // The "interrupt" preempts the consumer, as on the target
+        struct sched_param param = {.sched_priority = 2};
+        pthread_setschedparam(thread, SCHED_FIFO, &param);
+    }
+
+    uint64_t next = start_ns;
+    while (!__atomic_load_n(&producer_done, __ATOMIC_ACQUIRE) || uart_dataAvailable(&port) != 0)
+    {
+        if (config->consumer == SIM_POLL)
+        {
+            next += (uint64_t)config->period * 1000ULL;
+            sleep_until(next);
+            size_t count = uart_dataAvailable(&port);
+            uart_readBuffer(&port, chunk, count);
+            for (size_t i = 0; i != count; i++)
+            {
+                if (line_len != SIM_LINE)
+                    line[line_len++] = (char)chunk[i];
+                if (chunk[i] == '\n')
+                {
+                    line_received(line, line_len, latencies, result);
+                    line_len = 0;
+                }
+            }
+        }
+        else
+        {
+            if (uart_getsTimeout(&port, line, sizeof(line), 20000) == NULL)
+                continue;
+            line_received(line, strlen(line), latencies, result);
+            sleep_until(mono_ns() + (uint64_t)config->period * 1000ULL);    // Work done per line
+        }
+        if (result->lines == max_lines)
+            break;
+    }
+    pthread_join(thread, NULL);
+
+    uart_getStats(&port, &stats, true);
+    result->produced = stats.rxBytes;
+    result->lost = stats.rxOverwritten;
+    result->peak = stats.rxPeak;
+    if (result->lines != 0)
+    {
+        qsort(latencies, result->lines, sizeof(uint32_t), latency_compare);
+        result->p50 = latencies[result->lines / 2];
+        result->p99 = latencies[(result->lines * 99) / 100];
+        result->max = latencies[result->lines - 1];
+    }
+    free(latencies);
+}
+
+/**
+ * @brief Runs a configuration 'repeats' times, stopping at the first run that loses data
+ * @return true Every run was lossless
+ */
+static bool sim_probe(const SimConfig *config, unsigned repeats)
+{
+    SimResult result;
+    for (unsigned r = 0; r != repeats; r++)
+    {
+        sim_run(config, &result);
+        printf("%-10s %-6s %7lu %5zu %7lu %8lu %6lu %6lu %6lu %8lu %8lu %8lu\n", consumer_names[config->consumer], profile_names[config->profile],
+               (unsigned long)config->baud, config->size, (unsigned long)config->period, result.produced, result.lost,
+               result.corrupted, result.peak, (unsigned long)result.p50, (unsigned long)result.p99, (unsigned long)result.max);
+        if (result.lost != 0 || result.corrupted != 0)
+            return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Searches the longest lossless consumer period of a configuration. Losses are assumed to only
+ * grow with the period, which holds for both consumers
+ * @param limited Set if a lossy period was found (otherwise the period is safe up to the run duration)
+ * @return uint32_t Longest safe period found (us), 0 if even SIM_MIN_PERIOD loses data
+ */
+static uint32_t sim_search(SimConfig *config, unsigned repeats, bool *limited)
+{
+    uint64_t fill_ns = (uint64_t)config->size * UART_FRAME_BITS * 1000000000ULL / config->baud;    // Steady polling limit
+    if (config->duration < 4 * fill_ns)
+        config->duration = 4 * fill_ns;
+    uint32_t cap = (uint32_t)(config->duration / 1000ULL);
+    uint32_t lo = SIM_MIN_PERIOD;   // Safe
+    uint32_t hi = (uint32_t)(2 * fill_ns / 1000ULL);    // Candidate lossy
+    *limited = true;
+    config->period = lo;
+    if (!sim_probe(config, repeats))
+        return 0;
+    if (hi <= lo)
+        hi = 2 * lo;
+    // Grow the upper bound until some repeat loses data
+    for (;;)
+    {
+        config->period = hi;
+        if (!sim_probe(config, repeats))
+            break;
+        lo = hi;
+        if (hi >= cap)
+        {
+            *limited = false;
+            return lo;
+        }
+        hi = (2 * hi > cap) ? cap : 2 * hi;
+    }
+    while (hi - lo > lo / SIM_RESOLUTION && hi - lo > 1)
+    {
+        config->period = lo + (hi - lo) / 2;
+        if (sim_probe(config, repeats))
+            lo = config->period;
+        else
+            hi = config->period;
+    }
+    return lo;
+}
+
+int main(int argc, char const *argv[])
+{
+    unsigned long duration_ms = (argc > 1) ? strtoul(argv[1], NULL, 10) : 40;
+    unsigned repeats = (argc > 2) ? (unsigned)strtoul(argv[2], NULL, 10) : 3;
+    static uint32_t safe[SIM_CONSUMERS][SIM_PROFILES][SIM_BAUDS][SIM_SIZES];   // Longest period up to which nothing is lost, 0 if none
+    static bool limited[SIM_CONSUMERS][SIM_PROFILES][SIM_BAUDS][SIM_SIZES];   // A lossy period was found above it
+    SimConfig config;
+
+    sem_init(&sem, 0, 0);
+    struct sched_param param = {.sched_priority = 1};
+    realtime = (pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) == 0);
+    printf("threads: %s\n", realtime ? "SCHED_FIFO" : "default scheduling, host stalls count as losses");
+    if (repeats == 0)
+        repeats = 1;
+    printf("%-10s %-6s %7s %5s %7s %8s %6s %6s %6s %8s %8s %8s\n", "consumer", "traffic", "baud", "ring", "period", "bytes", "lost", "corrupt", "peak", "p50(us)", "p99(us)", "max(us)");
+    for (int c = 0; c != SIM_CONSUMERS; c++)
+    {
+        for (int p = 0; p != SIM_PROFILES; p++)
+        {
+            for (size_t b = 0; b != SIM_BAUDS; b++)
+            {
+                for (size_t s = 0; s != SIM_SIZES; s++)
+                {
+                    config.baud = bauds[b];
+                    config.size = sizes[s];
+                    config.profile = (SimProfile)p;
+                    config.consumer = (SimConsumer)c;
+                    config.duration = (uint64_t)duration_ms * 1000000ULL;
+                    safe[c][p][b][s] = sim_search(&config, repeats, &limited[c][p][b][s]);
+                }
+            }
+        }
+    }
+
+    // Safe operating region: longest consumer period (us) that lost nothing, per baud rate and ring size
+    printf("\nSafe region (longest period in us whose %u runs lost nothing, '-' if none, '>' if nothing was lost up to the\n"
+           "run duration; steady polling limit is ring * %d / baud)\n", repeats, UART_FRAME_BITS);
+    for (int c = 0; c != SIM_CONSUMERS; c++)
+    {
+        for (int p = 0; p != SIM_PROFILES; p++)
+        {
+            printf("%s, %s traffic\n%8s", consumer_names[c], profile_names[p], "baud");
+            for (size_t s = 0; s != SIM_SIZES; s++)
+            {
+                printf(" %8zu", sizes[s]);
+            }
+            printf("\n");
+            for (size_t b = 0; b != SIM_BAUDS; b++)
+            {
+                printf("%8lu", (unsigned long)bauds[b]);
+                for (size_t s = 0; s != SIM_SIZES; s++)
+                {
+                    if (safe[c][p][b][s] == 0)
+                        printf(" %8s", "-");
+                    else if (!limited[c][p][b][s])
+                        printf("   >%5lu", (unsigned long)safe[c][p][b][s]);
+                    else
+                        printf(" %8lu", (unsigned long)safe[c][p][b][s]);
+                }
+                printf("\n");
+            }
+        }
+    }
+    sem_destroy(&sem);
+    return EXIT_SUCCESS;
+}
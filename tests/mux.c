@@ -0,0 +1,180 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../src/uart_buffer.h"
+#include "../src/uart_mux.h"
+
+/*
+ * Multiplexer test: a host and a device mux are connected back to back (host link TX ring drained into
+ * device link RX ring). A shell, a log and an RPC channel exchange frames; every payload must arrive intact
+ * on its own channel. Then the log channel is flooded while RPC replies are queued, and the share of link
+ * frames taken by RPC must follow the configured weights.
+ */
+
+#define CH_SHELL    0
+#define CH_LOG      1
+#define CH_RPC      2
+#define FRAME_SIZE  64
+#define LINK_SIZE   128     // Small link ring: a few frames per uart_muxTransmit call
+#define CHANNEL_SIZE 4096
+
+typedef struct{
+    UARTBuffer link;
+    UARTBuffer channels[3];
+    uint8_t linkRx[LINK_SIZE], linkTx[LINK_SIZE];
+    uint8_t rx[3][CHANNEL_SIZE], tx[3][CHANNEL_SIZE];
+    uint8_t rxFrame[FRAME_SIZE], txFrame[FRAME_SIZE];
+    UARTMux mux;
+} Node;
+
+static Node host, device;
+
+void write_cb(uint8_t data)
+{
+    (void)data;
+}
+
+uint8_t read_cb()
+{
+    return 0;
+}
+
+void tx_enable_cb(bool enable)
+{
+    (void)enable;
+}
+
+static void node_init(Node *node, const uint16_t weights[3])
+{
+    uart_buffer_initStorage(&node->link, node->linkRx, LINK_SIZE, node->linkTx, LINK_SIZE, write_cb, read_cb);
+    uart_txInit(&node->link, tx_enable_cb, 115200);
+    uart_muxInit(&node->mux, &node->link, UART_FRAME_COBS, node->rxFrame, node->txFrame, FRAME_SIZE);
+    for (uint8_t i = 0; i != 3; i++)
+    {
+        uart_buffer_initStorage(&node->channels[i], node->rx[i], CHANNEL_SIZE, node->tx[i], CHANNEL_SIZE, write_cb, read_cb);
+        uart_muxAddChannel(&node->mux, i, &node->channels[i], weights[i]);
+    }
+}
+
+/**
+ * @brief Moves link bytes from one node to the other, as the wire would
+ */
+static size_t wire(Node *from, Node *to)
+{
+    UARTSpan out[2], in[2];
+    size_t pending = uart_txPeek(&from->link, out);
+    size_t space = uart_rxReserve(&to->link, in);
+    size_t len = (pending < space) ? pending : space;
+    uint8_t tmp[LINK_SIZE];
+    size_t first = (out[0].len < len) ? out[0].len : len;
+    memcpy(tmp, out[0].data, first);
+    memcpy(tmp + first, out[1].data, len - first);
+    first = (in[0].len < len) ? in[0].len : len;
+    memcpy(in[0].data, tmp, first);
+    memcpy(in[1].data, tmp + first, len - first);
+    uart_txConsume(&from->link, len);
+    uart_rxCommit(&to->link, len);
+    return len;
+}
+
+int main(int argc, char const *argv[])
+{
+    (void)argc;
+    (void)argv;
+    const uint16_t weights[3] = {32, 16, 64};
+    char line[64];
+    uint8_t payload[FRAME_SIZE];
+
+    // Demultiplexing: interleaved traffic on all channels, including payloads with zeros and empty frames
+    node_init(&host, weights);
+    node_init(&device, weights);
+    for (int i = 0; i != 50; i++)
+    {
+        snprintf(line, sizeof(line), "shell %d\n", i);
+        uart_muxWrite(&host.mux, CH_SHELL, line, strlen(line));
+        snprintf(line, sizeof(line), "log %d\n", i);
+        uart_muxWrite(&host.mux, CH_LOG, line, strlen(line));
+        for (size_t j = 0; j != (size_t)i; j++)
+        {
+            payload[j] = (uint8_t)(i * j);
+        }
+        uart_muxWrite(&host.mux, CH_RPC, payload, (size_t)i);
+        while (uart_muxTransmit(&host.mux) != 0 || uart_txPending(&host.link) != 0)
+        {
+            wire(&host, &device);
+            uart_muxReceive(&device.mux);
+        }
+    }
+    line[0] = 'x';    // No room for a line: nothing is read nor written
+    if (uart_gets(&device.channels[CH_SHELL], line, 0) != NULL ||
+        uart_getsTimeout(&device.channels[CH_SHELL], line, 0, 0) != NULL || line[0] != 'x')
+    {
+        printf("mux: zero sized line buffer written\n");
+        return EXIT_FAILURE;
+    }
+    for (int i = 0; i != 50; i++)
+    {
+        char expected[64];
+        snprintf(expected, sizeof(expected), "shell %d\n", i);
+        if (uart_getsTimeout(&device.channels[CH_SHELL], line, sizeof(line), 0) == NULL || strcmp(line, expected) != 0)
+        {
+            printf("mux: shell line %d mismatch\n", i);
+            return EXIT_FAILURE;
+        }
+        snprintf(expected, sizeof(expected), "log %d\n", i);
+        if (uart_getsTimeout(&device.channels[CH_LOG], line, sizeof(line), 0) == NULL || strcmp(line, expected) != 0)
+        {
+            printf("mux: log line %d mismatch\n", i);
+            return EXIT_FAILURE;
+        }
+        if (uart_readAvailable(&device.channels[CH_RPC], payload, (size_t)i) != (size_t)i)
+        {
+            printf("mux: rpc frame %d short\n", i);
+            return EXIT_FAILURE;
+        }
+        for (size_t j = 0; j != (size_t)i; j++)
+        {
+            if (payload[j] != (uint8_t)(i * j))
+            {
+                printf("mux: rpc frame %d corrupted\n", i);
+                return EXIT_FAILURE;
+            }
+        }
+    }
+    if (device.mux.rxInvalid != 0 || uart_dataAvailable(&device.channels[CH_RPC]) != 0)
+    {
+        printf("mux: unexpected data\n");
+        return EXIT_FAILURE;
+    }
+    printf("mux: 150 frames demultiplexed\n");
+
+    // Scheduling: log channel backlog vs RPC replies of the same size, link drained slowly
+    node_init(&host, weights);
+    node_init(&device, weights);
+    memset(payload, 'L', 32);
+    while (uart_muxWrite(&host.mux, CH_LOG, payload, 32))
+    {
+    }
+    memset(payload, 'R', 32);
+    for (int i = 0; i != 16; i++)
+    {
+        uart_muxWrite(&host.mux, CH_RPC, payload, 32);
+    }
+    size_t logFrames = 0, rpcFrames = 0;
+    while (rpcFrames != 16)
+    {
+        uart_muxTransmit(&host.mux);
+        wire(&host, &device);
+        uart_muxReceive(&device.mux);
+        logFrames += uart_readAvailable(&device.channels[CH_LOG], payload, sizeof(payload)) / 32;
+        rpcFrames += uart_readAvailable(&device.channels[CH_RPC], payload, sizeof(payload)) / 32;
+    }
+    printf("mux: 16 rpc frames sent alongside %lu log frames (weights %u:%u)\n", (unsigned long)logFrames, weights[CH_RPC], weights[CH_LOG]);
+    if (logFrames > 16UL * weights[CH_LOG] / weights[CH_RPC] + 3)
+    {
+        printf("mux: rpc starved by log traffic\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,165 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <time.h>
+#include "../src/uart_buffer.h"
+#include "../src/uart_printf.h"
+
+/*
+ * uart_printf test: every case is formatted with uart_printf (captured through writeByte) and with the C
+ * library snprintf, and both outputs must match. The few intended differences (conversions written as is,
+ * %f digits past UART_PRINTF_MAX_PRECISION) are checked against fixed text. Then formatting time is
+ * compared against snprintf plus uart_puts, the usual pattern for telemetry output.
+ */
+
+#define BENCH_LINES 200000
+
+UARTBuffer uart;
+static char output[512];
+static size_t output_len = 0;
+
+void write_cb(uint8_t data)
+{
+    if (output_len < sizeof(output) - 1)
+        output[output_len++] = (char)data;
+}
+
+uint8_t read_cb()
+{
+    return 0;
+}
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static int failures = 0;
+
+#define CHECK(...)                                                              \
+    do                                                                          \
+    {                                                                           \
+        char expected[512];                                                     \
+        int expected_len = snprintf(expected, sizeof(expected), __VA_ARGS__);   \
+        output_len = 0;                                                         \
+        int len = uart_printf(&uart, __VA_ARGS__);                              \
+        output[output_len] = '\0';                                              \
+        if (len != expected_len || strcmp(output, expected) != 0)               \
+        {                                                                       \
+            printf("FAIL %s: got \"%s\" (%d), expected \"%s\" (%d)\n",          \
+                   #__VA_ARGS__, output, len, expected, expected_len);          \
+            failures++;                                                         \
+        }                                                                       \
+    } while (0)
+
+/**
+ * @brief Cases where uart_printf differs from snprintf on purpose: unsupported conversions are written as is
+ */
+#define CHECK_TEXT(text, ...)                                                   \
+    do                                                                          \
+    {                                                                           \
+        output_len = 0;                                                         \
+        int len = uart_printf(&uart, __VA_ARGS__);                              \
+        output[output_len] = '\0';                                              \
+        if (len != (int)strlen(text) || strcmp(output, text) != 0)              \
+        {                                                                       \
+            printf("FAIL %s: got \"%s\" (%d), expected \"%s\"\n",              \
+                   #__VA_ARGS__, output, len, text);                            \
+            failures++;                                                         \
+        }                                                                       \
+    } while (0)
+
+static void check_fixed(int32_t value, uint8_t fracBits, uint8_t decimals, const char *expected)
+{
+    output_len = 0;
+    int len = uart_printFixed(&uart, value, fracBits, decimals);
+    output[output_len] = '\0';
+    if (len != (int)strlen(expected) || strcmp(output, expected) != 0)
+    {
+        printf("FAIL uart_printFixed(%ld, %u, %u): got \"%s\", expected \"%s\"\n", (long)value, fracBits, decimals, output, expected);
+        failures++;
+    }
+}
+
+int main(int argc, char const *argv[])
+{
+    (void)argc;
+    (void)argv;
+    uart_buffer_init(&uart, write_cb, read_cb);
+
+    CHECK("plain text");
+    CHECK("%d %i %d %d", 0, -1, INT32_MAX, INT32_MIN);
+    CHECK("%u %lu %llu", 4000000000U, 123456789UL, 18446744073709551615ULL);
+    CHECK("%lld %lld", -9223372036854775807LL - 1, 1234567890123LL);
+    CHECK("%hhd %hd %hhu %hu", 300, 70000, 300, 70000);
+    CHECK("%zu %zd %td %jd", (size_t)42, (ptrdiff_t)-42, (ptrdiff_t)7, (intmax_t)-7);
+    CHECK("[%5d] [%-5d] [%05d] [%+d] [% d] [%+05d]", 42, 42, -42, 42, 42, -42);
+    CHECK("[%.3d] [%8.3d] [%-8.3d] [%.0d]", 7, -7, 7, 0);
+    CHECK("%x %X %#x %#X %#x %08x %#010x", 0xBEEFU, 0xBEEFU, 0xBEEFU, 0xBEEFU, 0U, 0x1234U, 0xABCU);
+    CHECK("%llx %o %#o %#o %#.5o", 0xFEEDFACECAFEBEEFULL, 8U, 8U, 0U, 8U);
+    CHECK("%c%c%c [%3c] [%-3c]", 'a', 'b', 'c', 'x', 'y');
+    CHECK("[%s] [%10s] [%-10s] [%.3s] [%*s] [%-*s] [%.*s]", "str", "str", "str", "string", 6, "ab", 6, "ab", 2, "abcdef");
+    CHECK("100%% %d%%", 5);
+    CHECK("%p", (void *)0x1234);
+    CHECK("[%p] [%10p] [%-8p]", (void *)0, (void *)0, (void *)0);
+    // The double argument is skipped, so the following ones are still read right
+    CHECK_TEXT("%e 7 %g x", "%e %d %g %s", 1.5, 7, 2.5, "x");
+#if defined(UART_PRINTF_FLOAT) && (UART_PRINTF_FLOAT > 0)
+    CHECK("%f %f %f %f", 0.0, 1.5, -2.25, 3.14159265);
+    CHECK("%.0f %.1f %.2f %.3f %.9f", 2.7, 0.96, 99.999, -0.0004, 1.000000001);
+    CHECK("[%10.3f] [%-10.3f] [%010.3f] [%+.2f] [% .2f] [%#.0f]", 3.14159, 3.14159, -3.14159, 1.0, 1.0, 3.0);
+    CHECK("%f %.2f %F", 123456789.125, 1e15, 42.5);
+    CHECK("%f %f %f", -0.0, 1.0 / 0.0, -1.0 / 0.0);
+    // Exact halfway values round to even, like snprintf
+    CHECK("%.2f %.2f %.1f %.1f %.3f", 0.125, 0.375, 0.25, -0.75, 1.0625);
+    CHECK("%.0f %.0f %.0f %.0f %.0f", 0.5, 1.5, 2.5, -3.5, 4.5);
+    CHECK("%.2f %.1f %.0f", 0.1251, 0.2500001, 2.5000001);
+    // Precision beyond UART_PRINTF_MAX_PRECISION is padded with zeros
+    CHECK("%.12f %.15f [%-18.12f] [%18.10f] %.20f", 0.5, 1.25, -0.375, 2.0, 3.0);
+    CHECK("%.12f", 0.1);
+    CHECK_TEXT("0.33333333300", "%.11f", 1.0 / 3.0);
+    CHECK_TEXT("0.000000000000", "%.12f", 5e-10);     // Truncated past UART_PRINTF_MAX_PRECISION, not rounded
+    CHECK_TEXT("0.9999999990", "%.10f", 0.99999999999);
+#else
+    CHECK_TEXT("%f 7 %.2F x", "%f %d %.2F %s", 1.5, 7, 2.5, "x");
+#endif
+
+    check_fixed(0x00018000, 16, 2, "1.50");
+    check_fixed(-0x00018000, 16, 3, "-1.500");
+    check_fixed(0x0003243F, 16, 4, "3.1416");
+    check_fixed(0x0000FFFF, 16, 2, "1.00");
+    check_fixed(1234, 0, 0, "1234");
+    check_fixed(INT32_MIN, 31, 3, "-1.000");
+    check_fixed(12345, 8, 0, "48");
+
+    if (failures != 0)
+    {
+        printf("%d failures\n", failures);
+        return EXIT_FAILURE;
+    }
+    printf("uart_printf: all cases match snprintf\n");
+
+    // Telemetry-like line, formatted directly vs snprintf into a stack buffer and uart_puts
+    double start = now_s();
+    for (int i = 0; i != BENCH_LINES; i++)
+    {
+        output_len = 0;
+        uart_printf(&uart, "t=%lu ch%d adc=%5u temp=%d.%02d flags=%#06x\r\n", (unsigned long)i * 10, i & 7, (unsigned)(i * 7) & 0xFFF, 20 + (i & 15), i % 100, (unsigned)i & 0xFF);
+    }
+    double direct = now_s() - start;
+    start = now_s();
+    for (int i = 0; i != BENCH_LINES; i++)
+    {
+        char line[96];
+        output_len = 0;
+        snprintf(line, sizeof(line), "t=%lu ch%d adc=%5u temp=%d.%02d flags=%#06x\r\n", (unsigned long)i * 10, i & 7, (unsigned)(i * 7) & 0xFFF, 20 + (i & 15), i % 100, (unsigned)i & 0xFF);
+        uart_puts(&uart, line);
+    }
+    double buffered = now_s() - start;
+    printf("telemetry line: uart_printf %.1f ns, snprintf+uart_puts %.1f ns\n", direct * 1e9 / BENCH_LINES, buffered * 1e9 / BENCH_LINES);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,118 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+#include "../src/uart_buffer.h"
+#include "../src/uart_posix.h"
+
+/*
+ * Pseudo-terminal loopback: two UART buffers attached to both ends of a pty exchange a byte sequence in
+ * both directions at host speed, through the regular writer/reader API.
+ */
+
+#define LOOPBACK_BYTES (4UL * 1024UL * 1024UL)
+
+UARTBuffer master;
+UARTBuffer slave;
+
+void write_cb(uint8_t data)
+{
+    (void)data;
+}
+
+uint8_t read_cb()
+{
+    return 0;
+}
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/**
+ * @brief Queues as much of the sequence as fits in TX ring
+ */
+static void send_sequence(UARTBuffer *buffer, unsigned long *sent, uint8_t *value)
+{
+    uint8_t block[61];
+    while (*sent != LOOPBACK_BYTES && uart_txSpace(buffer) != 0)
+    {
+        size_t len = uart_txSpace(buffer);
+        if (len > sizeof(block))
+            len = sizeof(block);
+        if (len > LOOPBACK_BYTES - *sent)
+            len = (size_t)(LOOPBACK_BYTES - *sent);
+        for (size_t i = 0; i != len; i++)
+        {
+            block[i] = (uint8_t)(*value + i);
+        }
+        len = uart_writeAsync(buffer, block, len);
+        *value = (uint8_t)(*value + len);
+        *sent += len;
+    }
+}
+
+/**
+ * @brief Checks received data against the expected sequence
+ */
+static bool check_sequence(UARTBuffer *buffer, unsigned long *received, uint8_t *expected)
+{
+    uint8_t chunk[97];
+    size_t count;
+    while ((count = uart_readAvailable(buffer, chunk, sizeof(chunk))) != 0)
+    {
+        for (size_t i = 0; i != count; i++, (*received)++)
+        {
+            if (chunk[i] != *expected)
+            {
+                printf("Sequence error at byte %lu: expected 0x%02X, got 0x%02X\n", *received, *expected, chunk[i]);
+                return false;
+            }
+            (*expected)++;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char const *argv[])
+{
+    (void)argc;
+    (void)argv;
+    static uint8_t master_rx[8192], master_tx[4096], slave_rx[8192], slave_tx[4096];
+    UARTPosixPort masterPort, slavePort;
+    char slavePath[64];
+
+    uart_buffer_initStorage(&master, master_rx, sizeof(master_rx), master_tx, sizeof(master_tx), write_cb, read_cb);
+    uart_buffer_initStorage(&slave, slave_rx, sizeof(slave_rx), slave_tx, sizeof(slave_tx), write_cb, read_cb);
+    if (uart_posixOpenPty(&masterPort, &master, slavePath, sizeof(slavePath)) != 0 ||
+        uart_posixOpen(&slavePort, &slave, slavePath, 115200) != 0)
+    {
+        perror("pty");
+        return EXIT_FAILURE;
+    }
+
+    unsigned long sent[2] = {0, 0}, received[2] = {0, 0};
+    uint8_t value[2] = {0, 0x80}, expected[2] = {0, 0x80};
+    double start = now_s();
+    while (received[0] != LOOPBACK_BYTES || received[1] != LOOPBACK_BYTES)
+    {
+        send_sequence(&master, &sent[0], &value[0]);
+        send_sequence(&slave, &sent[1], &value[1]);
+        if (uart_posixPoll(&masterPort, 0) < 0 || uart_posixPoll(&slavePort, 10) < 0)
+        {
+            perror("uart_posixPoll");
+            return EXIT_FAILURE;
+        }
+        if (!check_sequence(&slave, &received[0], &expected[0]) || !check_sequence(&master, &received[1], &expected[1]))
+            return EXIT_FAILURE;
+    }
+    double elapsed = now_s() - start;
+    printf("pty loopback: 2 x %lu bytes in %.3f s (%.1f MB/s per direction)\n", LOOPBACK_BYTES, elapsed, (double)LOOPBACK_BYTES / elapsed / 1e6);
+
+    uart_posixClose(&slavePort);
+    uart_posixClose(&masterPort);
+    return EXIT_SUCCESS;
+}
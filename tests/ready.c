@@ -0,0 +1,197 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <errno.h>
+#include <semaphore.h>
+#include "../src/uart_buffer.h"
+
+/*
+ * Readiness set test: a producer thread plays the RX interrupt of READY_PORTS ports, sending numbered
+ * lines to them in bursts. The main thread sleeps in uart_waitAny and only reads the ports reported by
+ * the delimiter events; every line must arrive in order on its port. Then TX space events are checked.
+ */
+
+#define READY_PORTS     12
+#define READY_LINES     2000    // Per port
+#define READY_RING      256
+
+UARTBuffer ports[READY_PORTS];
+static uint8_t rx_storage[READY_PORTS][READY_RING];
+static uint8_t tx_storage[READY_PORTS][READY_RING];
+static UARTReadySet set;
+static const char *source = NULL;
+
+void write_cb(uint8_t data)
+{
+    (void)data;
+}
+
+uint8_t read_cb()
+{
+    return (uint8_t)*source++;
+}
+
+void tx_enable_cb(bool enable)
+{
+    (void)enable;
+}
+
+static uint32_t now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u);
+}
+
+static void wait_cb(void *context, uint32_t timeout)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    if (timeout == UART_WAIT_FOREVER)
+    {
+        while (sem_wait((sem_t *)context) != 0 && errno == EINTR){}
+        return;
+    }
+    ts.tv_sec += timeout / 1000000u;
+    ts.tv_nsec += (long)(timeout % 1000000u) * 1000L;
+    if (ts.tv_nsec >= 1000000000L)
+    {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000L;
+    }
+    sem_timedwait((sem_t *)context, &ts);
+}
+
+static void wake_cb(void *context)
+{
+    int value;
+    if (sem_getvalue((sem_t *)context, &value) == 0 && value == 0)
+        sem_post((sem_t *)context);
+}
+
+static void *producer(void *arg)
+{
+    (void)arg;
+    char line[32];
+    unsigned seed = 1;
+    int sent[READY_PORTS] = {0};
+    int remaining = READY_PORTS * READY_LINES;
+    while (remaining != 0)
+    {
+        // Bursts to a few random ports, the rest stay idle
+        seed = seed * 1103515245u + 12345u;
+        int port = (int)((seed >> 16) % READY_PORTS);
+        if (sent[port] == READY_LINES)
+            continue;
+        snprintf(line, sizeof(line), "p%d line %d\n", port, sent[port]);
+        for (source = line; *source != '\0';)
+        {
+            UARTSpan spans[2];
+            while (uart_rxReserve(&ports[port], spans) == 0)
+            {
+                sched_yield();  // Lossless: wait for the reader as a flow-controlled peer would
+            }
+            uart_interruptHandler(&ports[port]);
+        }
+        sent[port]++;
+        remaining--;
+    }
+    return NULL;
+}
+
+int main(int argc, char const *argv[])
+{
+    (void)argc;
+    (void)argv;
+    static sem_t sem;
+    static char lines[READY_PORTS][32];
+    UARTLineReader readers[READY_PORTS];
+    int received[READY_PORTS] = {0};
+    unsigned long waits = 0, visits = 0;
+    pthread_t thread;
+
+    sem_init(&sem, 0, 0);
+    uart_readyInit(&set, now_us, wait_cb, wake_cb, &sem);
+    for (int i = 0; i != READY_PORTS; i++)
+    {
+        uart_buffer_initStorage(&ports[i], rx_storage[i], READY_RING, tx_storage[i], READY_RING, write_cb, read_cb);
+        uart_setReadySet(&ports[i], &set, (uint8_t)i, READY_RING / 2, 0, '\n');
+        uart_lineReaderInit(&readers[i], lines[i], sizeof(lines[i]), '\n');
+    }
+
+    // Nothing received yet: a timed wait expires
+    UARTReadyEvents events;
+    uint32_t start = now_us();
+    if (uart_waitAny(&set, &events, 2000) != 0 || now_us() - start < 2000)
+    {
+        printf("ready: unexpected event on idle ports\n");
+        return EXIT_FAILURE;
+    }
+
+    pthread_create(&thread, NULL, producer, NULL);
+    int remaining = READY_PORTS * READY_LINES;
+    while (remaining != 0)
+    {
+        uint32_t ready = uart_waitAny(&set, &events, 1000000);
+        waits++;
+        if (ready == 0)
+        {
+            printf("ready: timeout with %d lines pending\n", remaining);
+            return EXIT_FAILURE;
+        }
+        while (ready != 0)
+        {
+            int port = __builtin_ctz(ready);
+            ready &= ready - 1;
+            visits++;
+            char *line;
+            while ((line = uart_getLine(&ports[port], &readers[port])) != NULL)
+            {
+                char expected[32];
+                snprintf(expected, sizeof(expected), "p%d line %d\n", port, received[port]);
+                if (strcmp(line, expected) != 0)
+                {
+                    printf("ready: port %d got \"%s\", expected \"%s\"\n", port, line, expected);
+                    return EXIT_FAILURE;
+                }
+                received[port]++;
+                remaining--;
+            }
+        }
+    }
+    pthread_join(thread, NULL);
+    printf("ready: %d lines on %d ports, %lu waits, %lu port visits (%.2f per wait)\n",
+           READY_PORTS * READY_LINES, READY_PORTS, waits, visits, (double)visits / (double)waits);
+
+    // TX space: a full TX ring isn't ready until the drain frees txThreshold bytes
+    uart_txInit(&ports[0], tx_enable_cb, 115200);
+    uart_setReadySet(&ports[0], &set, 0, 1, READY_RING / 4, UART_READY_NO_DELIMITER);
+    uart_writeAsync(&ports[0], tx_storage[1], READY_RING);
+    if (uart_waitAny(&set, &events, 0) != 0)
+    {
+        printf("ready: TX ready with a full ring\n");
+        return EXIT_FAILURE;
+    }
+    for (int i = 0; i != READY_RING / 4 - 1; i++)
+    {
+        uart_txInterruptHandler(&ports[0]);
+    }
+    if (uart_waitAny(&set, &events, 0) != 0)
+    {
+        printf("ready: TX ready below threshold\n");
+        return EXIT_FAILURE;
+    }
+    uart_txInterruptHandler(&ports[0]);
+    if (uart_waitAny(&set, &events, 0) != 1 || events.tx != 1)
+    {
+        printf("ready: TX space not reported\n");
+        return EXIT_FAILURE;
+    }
+    printf("ready: TX space threshold ok\n");
+    sem_destroy(&sem);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,190 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+#include "../src/uart_buffer.h"
+#include "../src/uart_capture.h"
+
+/*
+ * Capture/replay test: synthetic line traffic with known timing is recorded through the interrupt
+ * handler, then replayed into another buffer (as fast as possible and at 10x speed) while the main
+ * thread reads it back with uart_gets. Last, two different captures are replayed at once into two
+ * buffers, from two threads.
+ */
+
+#define REPLAY_LINES    200
+#define REPLAY_BYTE_US  87      // 115200 baud, 8N1
+#define REPLAY_GAP_US   5000    // Idle time between lines
+#define REPLAY_SPEED    10.0
+
+UARTBuffer recorder;
+UARTBuffer player;
+UARTBuffer player2;
+static uint8_t log_storage[64 * 1024];
+static uint8_t log_storage2[64 * 1024];
+static size_t log_len = 0;
+static size_t log_len2 = 0;
+static uint32_t fake_time = 0;
+static const char *source = NULL;
+
+void write_cb(uint8_t data)
+{
+    (void)data;
+}
+
+uint8_t read_cb()
+{
+    return (uint8_t)*source++;
+}
+
+uint32_t fake_time_cb(void)
+{
+    return fake_time;
+}
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static void make_line(char *line, size_t size, int i)
+{
+    snprintf(line, size, "$GPGGA,%06d,4807.038,N,01131.000,E*%02X\r\n", i, i & 0xFF);
+}
+
+static void *player_thread(void *arg)
+{
+    double *speed = (double *)arg;
+    UARTReplay replay;
+    uart_replayInit(&replay, &player, log_storage, log_len, true);
+    return (void *)uart_replayRun(&replay, *speed);
+}
+
+static void *player2_thread(void *arg)
+{
+    (void)arg;
+    UARTReplay replay;
+    uart_replayInit(&replay, &player2, log_storage2, log_len2, true);
+    return (void *)uart_replayRun(&replay, 0);
+}
+
+/**
+ * @brief Records REPLAY_LINES lines, numbered from 'first', into 'capture'
+ * @return size_t Recorded byte quantity
+ */
+static size_t record(UARTCapture *capture, uint8_t *storage, size_t size, int first)
+{
+    char line[64];
+    size_t total = 0;
+    uart_buffer_init(&recorder, write_cb, read_cb);
+    uart_captureInit(capture, storage, size, fake_time_cb);
+    uart_setCapture(&recorder, capture);
+    fake_time = 0;
+    for (int i = first; i != first + REPLAY_LINES; i++)
+    {
+        make_line(line, sizeof(line), i);
+        fake_time += REPLAY_GAP_US;
+        for (source = line; *source != '\0';)
+        {
+            fake_time += REPLAY_BYTE_US;
+            uart_interruptHandler(&recorder);
+            total++;
+        }
+        uart_flushBuffer(&recorder);
+    }
+    return total;
+}
+
+int main(int argc, char const *argv[])
+{
+    (void)argc;
+    (void)argv;
+    char line[64], expected[64];
+    UARTCapture capture;
+
+    // Record: every byte is stamped with the fake clock, advanced as the wire would
+    size_t total = record(&capture, log_storage, sizeof(log_storage), 0);
+    printf("capture: %lu bytes in %lu log bytes, %lu lost\n", (unsigned long)total, (unsigned long)capture.len, (unsigned long)capture.lost);
+    if (capture.lost != 0)
+        return EXIT_FAILURE;
+    log_len = capture.len;
+
+    double speeds[2] = {0, REPLAY_SPEED};
+    for (int s = 0; s != 2; s++)
+    {
+        pthread_t thread;
+        void *replayed;
+        uart_buffer_init(&player, write_cb, uart_replayReadByte);
+        double start = now_s();
+        pthread_create(&thread, NULL, player_thread, &speeds[s]);
+        for (int i = 0; i != REPLAY_LINES; i++)
+        {
+            make_line(expected, sizeof(expected), i);
+            if (uart_gets(&player, line, sizeof(line)) == NULL || strcmp(line, expected) != 0)
+            {
+                printf("replay: line %d mismatch\n", i);
+                return EXIT_FAILURE;
+            }
+        }
+        pthread_join(thread, &replayed);
+        double elapsed = now_s() - start;
+        if ((size_t)replayed != total)
+        {
+            printf("replay: %lu of %lu bytes\n", (unsigned long)(size_t)replayed, (unsigned long)total);
+            return EXIT_FAILURE;
+        }
+        if (speeds[s] > 0)
+        {
+            // First record carries no delay, so the replay lasts the capture length minus the first gap
+            double original = (double)(fake_time - REPLAY_GAP_US - REPLAY_BYTE_US) * 1e-6;
+            if (elapsed < original / speeds[s])
+            {
+                printf("replay: %.3f s, expected at least %.3f s\n", elapsed, original / speeds[s]);
+                return EXIT_FAILURE;
+            }
+        }
+        printf("replay speed=%.1f: %lu bytes in %.3f s\n", speeds[s], (unsigned long)total, elapsed);
+    }
+
+    // Two replays at once: each thread feeds its own buffer from its own capture
+    UARTCapture capture2;
+    size_t total2 = record(&capture2, log_storage2, sizeof(log_storage2), REPLAY_LINES);
+    log_len2 = capture2.len;
+    {
+        pthread_t threads[2];
+        void *replayed[2];
+        double speed = 0;
+        uart_buffer_init(&player, write_cb, uart_replayReadByte);
+        uart_buffer_init(&player2, write_cb, uart_replayReadByte);
+        pthread_create(&threads[0], NULL, player_thread, &speed);
+        pthread_create(&threads[1], NULL, player2_thread, NULL);
+        for (int i = 0; i != REPLAY_LINES; i++)
+        {
+            make_line(expected, sizeof(expected), i);
+            if (uart_gets(&player, line, sizeof(line)) == NULL || strcmp(line, expected) != 0)
+            {
+                printf("concurrent replay: port 1 line %d mismatch\n", i);
+                return EXIT_FAILURE;
+            }
+            make_line(expected, sizeof(expected), REPLAY_LINES + i);
+            if (uart_gets(&player2, line, sizeof(line)) == NULL || strcmp(line, expected) != 0)
+            {
+                printf("concurrent replay: port 2 line %d mismatch\n", i);
+                return EXIT_FAILURE;
+            }
+        }
+        pthread_join(threads[0], &replayed[0]);
+        pthread_join(threads[1], &replayed[1]);
+        if ((size_t)replayed[0] != total || (size_t)replayed[1] != total2)
+        {
+            printf("concurrent replay: %lu and %lu bytes\n", (unsigned long)(size_t)replayed[0], (unsigned long)(size_t)replayed[1]);
+            return EXIT_FAILURE;
+        }
+        printf("concurrent replay: %lu + %lu bytes\n", (unsigned long)total, (unsigned long)total2);
+    }
+    return EXIT_SUCCESS;
+}
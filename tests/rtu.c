@@ -0,0 +1,169 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../src/uart_buffer.h"
+#include "../src/uart_rtu.h"
+
+/*
+ * Modbus RTU framing test on a simulated clock: frames are received byte by byte at 9600 bps (one
+ * character every 1146 us) into a small timestamped ring, with gaps between them, while the master loop
+ * polls uart_rtuRead at random moments. Valid frames must come out whole; a corrupted frame and two
+ * frames sent too close together (seen as one) must be discarded.
+ */
+
+#define RTU_RING    64
+#define RTU_BAUD    9600
+#define RTU_CHAR_US 1146
+
+static UARTBuffer port;
+static uint8_t rx_storage[RTU_RING];
+static uint8_t tx_storage[RTU_RING];
+static uint32_t stamps[RTU_RING];
+static uint32_t clock_us = 0xFFFF0000u;     // Wraps around during the test
+static uint8_t next_byte;
+static uint8_t sent[64];
+static size_t sent_len = 0;
+
+void write_cb(uint8_t data)
+{
+    if (sent_len != sizeof(sent))
+        sent[sent_len++] = data;
+}
+
+uint8_t read_cb()
+{
+    return next_byte;
+}
+
+static uint32_t now_cb(void)
+{
+    return clock_us;
+}
+
+typedef struct{
+    uint8_t data[40];
+    size_t len;
+    uint32_t gapAfter;      // Silence after the frame, in microseconds
+    bool valid;
+} Frame;
+
+static size_t frame_make(Frame *frame, uint8_t address, uint8_t function, size_t payload, uint32_t gapAfter)
+{
+    frame->data[0] = address;
+    frame->data[1] = function;
+    for (size_t i = 0; i != payload; i++)
+    {
+        frame->data[2 + i] = (uint8_t)(address * 31 + i);
+    }
+    uint16_t crc = (uint16_t)uart_crcCompute(UART_CRC16_MODBUS, frame->data, 2 + payload);
+    frame->data[2 + payload] = (uint8_t)crc;
+    frame->data[3 + payload] = (uint8_t)(crc >> 8);
+    frame->len = 4 + payload;
+    frame->gapAfter = gapAfter;
+    frame->valid = true;
+    return frame->len;
+}
+
+int main(int argc, char const *argv[])
+{
+    (void)argc;
+    (void)argv;
+    static uint8_t storage[UART_RTU_MAX_FRAME];
+    UARTRtuFramer framer;
+    Frame frames[12];
+    unsigned seed = 3;
+    int failures = 0;
+
+    uart_buffer_initStorage(&port, rx_storage, RTU_RING, tx_storage, RTU_RING, write_cb, read_cb);
+    uart_setRxTimestamps(&port, stamps, now_cb);
+    uart_rtuInit(&framer, storage, sizeof(storage), RTU_BAUD);
+    if (framer.gap != 4011)
+    {
+        printf("rtu: t3.5 at %u bps is %u us\n", RTU_BAUD, (unsigned)framer.gap);
+        failures++;
+    }
+
+    for (int i = 0; i != 12; i++)
+    {
+        frame_make(&frames[i], (uint8_t)(i + 1), 3, (size_t)(4 + i * 2), 5000 + (uint32_t)i * 700);
+    }
+    frames[4].data[3] ^= 0x10;              // Corrupted on the line
+    frames[4].valid = false;
+    frames[7].gapAfter = 2 * RTU_CHAR_US;   // Too close to frame 8: both merge into one invalid frame
+    frames[7].valid = false;
+    frames[8].valid = false;
+
+    size_t expected = 0, received = 0;
+    for (int i = 0; i != 12; i++)
+    {
+        expected += frames[i].valid ? 1 : 0;
+        for (size_t b = 0; b <= frames[i].len; b++)
+        {
+            uint32_t silence = (b == frames[i].len) ? frames[i].gapAfter : RTU_CHAR_US;
+            if (b != frames[i].len)
+            {
+                next_byte = frames[i].data[b];
+                uart_interruptHandler(&port);
+            }
+            // The master loop polls a few times while time passes
+            for (uint32_t step = 0; step < silence;)
+            {
+                seed = seed * 1103515245u + 12345u;
+                uint32_t advance = 200 + (seed >> 16) % 1500;
+                if (advance > silence - step)
+                    advance = silence - step;
+                clock_us += advance;
+                step += advance;
+                size_t len = uart_rtuRead(&port, &framer);
+                if (len == 0)
+                    continue;
+                int match = -1;
+                for (int f = 0; f != 12; f++)
+                {
+                    if (frames[f].valid && frames[f].len - 2 == len && memcmp(frames[f].data, storage, len) == 0)
+                        match = f;
+                }
+                if (match != i)
+                {
+                    printf("rtu: unexpected frame of %zu bytes while receiving frame %d\n", len, i);
+                    failures++;
+                }
+                received++;
+            }
+        }
+    }
+    if (received != expected || framer.crcErrors != 2)
+    {
+        printf("rtu: %zu of %zu frames, %u CRC errors\n", received, expected, (unsigned)framer.crcErrors);
+        failures++;
+    }
+
+    // A buffer without timestamps can't be framed: nothing is returned nor consumed
+    static UARTBuffer unstamped;
+    static uint8_t unstamped_rx[RTU_RING];
+    static uint8_t unstamped_tx[RTU_RING];
+    uart_buffer_initStorage(&unstamped, unstamped_rx, RTU_RING, unstamped_tx, RTU_RING, write_cb, read_cb);
+    for (size_t b = 0; b != frames[0].len; b++)
+    {
+        next_byte = frames[0].data[b];
+        uart_interruptHandler(&unstamped);
+    }
+    clock_us += 10 * RTU_CHAR_US;
+    if (uart_rtuRead(&unstamped, &framer) != 0 || uart_dataAvailable(&unstamped) != frames[0].len)
+    {
+        printf("rtu: unstamped buffer was framed\n");
+        failures++;
+    }
+
+    // Replies get their CRC appended
+    uart_rtuWrite(&port, frames[0].data, frames[0].len - 2);
+    if (sent_len != frames[0].len || memcmp(sent, frames[0].data, sent_len) != 0)
+    {
+        printf("rtu: uart_rtuWrite sent a wrong frame\n");
+        failures++;
+    }
+
+    printf("rtu: %zu frames, %u CRC errors, %s\n", received, (unsigned)framer.crcErrors, failures == 0 ? "ok" : "FAILED");
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
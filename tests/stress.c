@@ -0,0 +1,611 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <errno.h>
+#include <semaphore.h>
+#include <signal.h>
+#include <sys/time.h>
+#include "../src/uart_buffer.h"
+
+/*
+ * SPSC stress test: a producer thread plays the role of the RX interrupt, a consumer thread
+ * drains the ring through the regular reader API and checks that the sequence arrives intact.
+ */
+
+#define STRESS_BYTES (16UL * 1024UL * 1024UL)
+
+UARTBuffer rx;
+static uint8_t next_byte = 0;
+static uint8_t next_sent = 0;
+static volatile bool tx_enabled = false;
+static volatile unsigned long tx_errors = 0;
+
+void write_cb(uint8_t data)
+{
+    if (data != next_sent++)
+        tx_errors++;
+}
+
+void tx_enable_cb(bool enable)
+{
+    tx_enabled = enable;
+}
+
+uint8_t read_cb()
+{
+    return next_byte++;
+}
+
+// Compile-time specialized port, read while lapped by its own interrupt handler
+#define STRESS_PORTS(X) X(port, 64, 64, 115200, read_cb, write_cb, tx_enable_cb)
+STRESS_PORTS(UART_PORT_DECLARE)
+STRESS_PORTS(UART_PORT_DEFINE)
+
+static void *producer(void *arg)
+{
+    (void)arg;
+    for (unsigned long i = 0; i != STRESS_BYTES; i++)
+    {
+        // A real UART would overrun here; the test waits so that no byte is lost
+        while ((uart_index_t)(__atomic_load_n(&rx.rxHead, __ATOMIC_RELAXED) - __atomic_load_n(&rx.rxTail, __ATOMIC_ACQUIRE)) >= rx.rxSize)
+        {
+            sched_yield();
+        }
+        uart_interruptHandler(&rx);
+    }
+    return NULL;
+}
+
+static size_t fifo_level = 0;
+
+size_t read_burst_cb(uint8_t *data, size_t max)
+{
+    // Emulates a hardware FIFO holding 'fifo_level' bytes
+    size_t count = max < fifo_level ? max : fifo_level;
+    fifo_level -= count;
+    for (size_t i = 0; i != count; i++)
+    {
+        data[i] = next_byte++;
+    }
+    return count;
+}
+
+static void *burst_producer(void *arg)
+{
+    (void)arg;
+    for (unsigned long produced = 0; produced < STRESS_BYTES;)
+    {
+        // Only fire the interrupt when the whole FIFO fits, so that no byte is overwritten
+        if (rx.rxSize - uart_dataAvailable(&rx) < 32)
+        {
+            sched_yield();
+            continue;
+        }
+        fifo_level = 16;
+        produced += uart_burstInterruptHandler(&rx);
+    }
+    return NULL;
+}
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/*
+ * Overwrite policy test: a timer signal plays the RX interrupt and preempts the reader at random points,
+ * as on a single core MCU. Each "interrupt" delivers more than a whole ring, so the reader is lapped
+ * whenever it's interrupted in the middle of a copy
+ */
+#define OVERWRITE_BYTES     (4UL * 1024UL * 1024UL)
+#define OVERWRITE_BURST     80
+#define OVERWRITE_LINE_BURST 16
+
+static volatile bool overwrite_burst = false;
+static volatile int overwrite_burst_len = OVERWRITE_BURST;
+static volatile unsigned long overwrite_bytes = OVERWRITE_BYTES;
+static volatile bool overwrite_port = false;
+static volatile unsigned long overwrite_produced = 0;
+
+static void overwrite_interrupt(int signum)
+{
+    (void)signum;
+    if (overwrite_produced >= overwrite_bytes)
+        return;
+    if (overwrite_port)
+    {
+        for (int i = 0; i != OVERWRITE_BURST; i++)
+        {
+            port_interruptHandler();
+        }
+        overwrite_produced += OVERWRITE_BURST;
+        return;
+    }
+    if (overwrite_burst)
+    {
+        fifo_level = OVERWRITE_BURST;
+        while (fifo_level != 0)
+        {
+            overwrite_produced += uart_burstInterruptHandler(&rx);
+        }
+        return;
+    }
+    for (int i = 0; i != overwrite_burst_len; i++)
+    {
+        uart_interruptHandler(&rx);
+    }
+    overwrite_produced += overwrite_burst_len;
+}
+
+enum { OVERWRITE_READ, OVERWRITE_POP, OVERWRITE_LINE };
+
+/**
+ * @brief Reads under overwrite policy while the ring is lapped. Byte values are their ring index, so every
+ * byte returned must match the index it was consumed from, and returned plus overwritten bytes must add
+ * up to what was produced. Line reads are only done on a full ring and with interrupts shorter than a
+ * line, so an interrupt during the copy overwrites part of it
+ */
+static bool overwrite_run(const char *name, bool burst, int mode)
+{
+    static uint8_t small_rx[64];
+    static uint8_t small_tx[64];
+    struct itimerval timer = {{0, 20}, {0, 20}};
+    struct itimerval stop = {{0, 0}, {0, 0}};
+    uint8_t chunk[37];
+    char line[sizeof(chunk) + 1];
+    UARTLineReader reader;
+    unsigned long received = 0;
+    UARTStats stats;
+
+    uart_buffer_initStorage(&rx, small_rx, sizeof(small_rx), small_tx, sizeof(small_tx), write_cb, read_cb);
+    uart_rxBurstInit(&rx, read_burst_cb);
+    next_byte = 0;
+    fifo_level = 0;
+    overwrite_burst = burst;
+    overwrite_burst_len = (mode == OVERWRITE_LINE) ? OVERWRITE_LINE_BURST : OVERWRITE_BURST;
+    overwrite_bytes = (mode == OVERWRITE_LINE) ? OVERWRITE_BYTES / 4 : OVERWRITE_BYTES;
+    overwrite_produced = 0;
+    uart_lineReaderInit(&reader, line, sizeof(line), '\n');
+    signal(SIGALRM, overwrite_interrupt);
+    double start = now_s();
+    setitimer(ITIMER_REAL, &timer, NULL);
+    for (;;)
+    {
+        bool done = (overwrite_produced >= overwrite_bytes);
+        const uint8_t *data = chunk;
+        size_t count;
+        if (mode == OVERWRITE_POP)
+        {
+            count = uart_popByte(&rx, chunk) ? 1 : 0;
+        }
+        else if (mode == OVERWRITE_LINE)
+        {
+            // Bytes appended by this call are the ones after the partial line kept in the reader
+            size_t before = reader.len;
+            while (!done && uart_dataAvailable(&rx) != sizeof(small_rx))
+            {
+                done = (overwrite_produced >= overwrite_bytes);
+            }
+            if (uart_getLine(&rx, &reader) != NULL)
+            {
+                const char *end = memchr(line, '\n', sizeof(line) - 1);
+                count = (reader.truncated ? sizeof(line) - 1 : (size_t)(end - line) + 1) - before;
+            }
+            else
+            {
+                count = reader.len - before;
+            }
+            data = (const uint8_t *)line + before;
+        }
+        else
+        {
+            count = uart_readAvailable(&rx, chunk, sizeof(chunk));
+        }
+        uart_index_t tail = rx.rxTail;    // Only written by the reader
+        for (size_t i = 0; i != count; i++)
+        {
+            uint8_t expected = (uint8_t)(tail - count + i);
+            if (data[i] != expected)
+            {
+                setitimer(ITIMER_REAL, &stop, NULL);
+                printf("%s: torn read at index %lu: expected 0x%02X, got 0x%02X\n", name, (unsigned long)(uart_index_t)(tail - count + i), expected, data[i]);
+                return false;
+            }
+        }
+        received += count;
+        if (count == 0 && done && uart_dataAvailable(&rx) == 0)
+            break;
+    }
+    setitimer(ITIMER_REAL, &stop, NULL);
+    double elapsed = now_s() - start;
+    uart_getStats(&rx, &stats, true);
+    if (received + stats.rxOverwritten != overwrite_produced)
+    {
+        printf("%s: %lu received + %lu overwritten != %lu produced\n", name, received, (unsigned long)stats.rxOverwritten, overwrite_produced);
+        return false;
+    }
+    printf("%s: %lu bytes in %.3f s, %lu received, %lu overwritten\n", name, overwrite_produced, elapsed, received, (unsigned long)stats.rxOverwritten);
+    return true;
+}
+
+/**
+ * @brief Same as overwrite_run for the specialized port, whose handlers keep no statistics: bytes skipped
+ * by the reader are the difference between its final tail and what was received
+ */
+static bool overwrite_port_run(void)
+{
+    struct itimerval timer = {{0, 20}, {0, 20}};
+    struct itimerval stop = {{0, 0}, {0, 0}};
+    unsigned long received = 0;
+    uint8_t c;
+
+    next_byte = 0;
+    overwrite_port = true;
+    overwrite_bytes = OVERWRITE_BYTES;
+    overwrite_produced = 0;
+    signal(SIGALRM, overwrite_interrupt);
+    double start = now_s();
+    setitimer(ITIMER_REAL, &timer, NULL);
+    for (;;)
+    {
+        bool done = (overwrite_produced >= overwrite_bytes);
+        if (port_readByte(&c))
+        {
+            uint8_t expected = (uint8_t)(port.rxTail - 1);
+            if (c != expected)
+            {
+                setitimer(ITIMER_REAL, &stop, NULL);
+                printf("overwrite port: torn read at index %lu: expected 0x%02X, got 0x%02X\n", (unsigned long)(uart_index_t)(port.rxTail - 1), expected, c);
+                return false;
+            }
+            received++;
+        }
+        else if (done)
+        {
+            break;
+        }
+    }
+    setitimer(ITIMER_REAL, &stop, NULL);
+    overwrite_port = false;
+    double elapsed = now_s() - start;
+    if (port.rxTail != (uart_index_t)overwrite_produced || received > overwrite_produced)
+    {
+        printf("overwrite port: tail %lu after %lu produced, %lu received\n", (unsigned long)port.rxTail, overwrite_produced, received);
+        return false;
+    }
+    printf("overwrite port: %lu bytes in %.3f s, %lu received, %lu overwritten\n", overwrite_produced, elapsed, received, overwrite_produced - received);
+    return true;
+}
+
+static volatile bool peer_stopped = false;
+
+void flow_control_cb(bool stop)
+{
+    peer_stopped = stop;
+}
+
+static void *flow_controlled_producer(void *arg)
+{
+    (void)arg;
+    for (unsigned long i = 0; i != STRESS_BYTES; i++)
+    {
+        // The peer only looks at the flow control line, never at the ring
+        while (peer_stopped)
+        {
+            sched_yield();
+        }
+        uart_interruptHandler(&rx);
+    }
+    return NULL;
+}
+
+static void *dma_producer(void *arg)
+{
+    (void)arg;
+    UARTSpan spans[2];
+    for (unsigned long produced = 0; produced != STRESS_BYTES;)
+    {
+        if (uart_rxReserve(&rx, spans) == 0)
+        {
+            sched_yield();
+            continue;
+        }
+        // Fill only part of the free space, as a DMA transfer completing early would
+        size_t len = spans[0].len > 29 ? 29 : spans[0].len;
+        for (size_t i = 0; i != len; i++)
+        {
+            spans[0].data[i] = next_byte++;
+        }
+        uart_rxCommit(&rx, len);
+        produced += len;
+    }
+    return NULL;
+}
+
+static void *tx_interrupt(void *arg)
+{
+    (void)arg;
+    for (unsigned long sent = 0; sent != STRESS_BYTES;)
+    {
+        if (!tx_enabled || uart_txPending(&rx) == 0)
+        {
+            sched_yield();
+            continue;
+        }
+        uart_txInterruptHandler(&rx);
+        sent++;
+    }
+    return NULL;
+}
+
+static uint32_t now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u);
+}
+
+static void rx_wait_cb(void *context, uint32_t timeout)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    if (timeout == UART_WAIT_FOREVER)
+    {
+        while (sem_wait((sem_t *)context) != 0 && errno == EINTR){}
+        return;
+    }
+    ts.tv_sec += timeout / 1000000u;
+    ts.tv_nsec += (long)(timeout % 1000000u) * 1000L;
+    if (ts.tv_nsec >= 1000000000L)
+    {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000L;
+    }
+    sem_timedwait((sem_t *)context, &ts);
+}
+
+static void rx_wake_cb(void *context)
+{
+    int value;
+    // Keeps the count bounded, a single pending wake is enough for the reader
+    if (sem_getvalue((sem_t *)context, &value) == 0 && value == 0)
+        sem_post((sem_t *)context);
+}
+
+int main(int argc, char const *argv[])
+{
+    (void)argc;
+    (void)argv;
+    pthread_t thread;
+    uint8_t expected = 0;
+    uint8_t c;
+
+    uart_buffer_init(&rx, write_cb, read_cb);
+    double start = now_s();
+    pthread_create(&thread, NULL, producer, NULL);
+    for (unsigned long i = 0; i != STRESS_BYTES; i++)
+    {
+        while (uart_dataAvailable(&rx) == 0)
+        {
+            sched_yield();
+        }
+        uart_readByteBuffer(&rx, &c);
+        if (c != expected)
+        {
+            printf("Sequence error at byte %lu: expected 0x%02X, got 0x%02X\n", i, expected, c);
+            return EXIT_FAILURE;
+        }
+        expected++;
+    }
+    pthread_join(thread, NULL);
+    double elapsed = now_s() - start;
+    printf("readByteBuffer: %lu bytes in %.3f s (%.1f MB/s)\n", STRESS_BYTES, elapsed, (double)STRESS_BYTES / elapsed / 1e6);
+
+    // Same transfer through the bulk reader on a large caller-owned ring, with an odd chunk size so that
+    // copies straddle the wrap-around point
+    static uint8_t rx_storage[65536];
+    static uint8_t tx_storage[256];
+    uint8_t chunk[37];
+    if (!uart_buffer_initStorage(&rx, rx_storage, sizeof(rx_storage), tx_storage, sizeof(tx_storage), write_cb, read_cb))
+    {
+        printf("uart_buffer_initStorage failed\n");
+        return EXIT_FAILURE;
+    }
+    unsigned long received = 0;
+    start = now_s();
+    pthread_create(&thread, NULL, producer, NULL);
+    while (received != STRESS_BYTES)
+    {
+        size_t count = uart_readAvailable(&rx, chunk, sizeof(chunk));
+        if (count == 0)
+        {
+            sched_yield();
+        }
+        for (size_t i = 0; i != count; i++, received++)
+        {
+            if (chunk[i] != expected)
+            {
+                printf("Sequence error at byte %lu: expected 0x%02X, got 0x%02X\n", received, expected, chunk[i]);
+                return EXIT_FAILURE;
+            }
+            expected++;
+        }
+    }
+    pthread_join(thread, NULL);
+    elapsed = now_s() - start;
+    printf("readAvailable: %lu bytes in %.3f s (%.1f MB/s)\n", STRESS_BYTES, elapsed, (double)STRESS_BYTES / elapsed / 1e6);
+
+    // Burst interrupt handler draining a hardware FIFO
+    uart_rxBurstInit(&rx, read_burst_cb);
+    received = 0;
+    start = now_s();
+    pthread_create(&thread, NULL, burst_producer, NULL);
+    while (received != STRESS_BYTES)
+    {
+        size_t count = uart_readAvailable(&rx, chunk, (STRESS_BYTES - received < sizeof(chunk)) ? (size_t)(STRESS_BYTES - received) : sizeof(chunk));
+        if (count == 0)
+        {
+            sched_yield();
+        }
+        for (size_t i = 0; i != count; i++, received++)
+        {
+            if (chunk[i] != expected)
+            {
+                printf("Sequence error at byte %lu: expected 0x%02X, got 0x%02X\n", received, expected, chunk[i]);
+                return EXIT_FAILURE;
+            }
+            expected++;
+        }
+    }
+    pthread_join(thread, NULL);
+    elapsed = now_s() - start;
+    printf("burstInterruptHandler: %lu bytes in %.3f s (%.1f MB/s)\n", STRESS_BYTES, elapsed, (double)STRESS_BYTES / elapsed / 1e6);
+
+    // Zero-copy: a DMA-like producer writes through uart_rxReserve, the consumer parses in place
+    UARTSpan spans[2];
+    received = 0;
+    start = now_s();
+    pthread_create(&thread, NULL, dma_producer, NULL);
+    while (received != STRESS_BYTES)
+    {
+        size_t count = uart_peek(&rx, spans);
+        if (count == 0)
+        {
+            sched_yield();
+        }
+        for (size_t s = 0; s != 2; s++)
+        {
+            for (size_t i = 0; i != spans[s].len; i++)
+            {
+                if (spans[s].data[i] != expected)
+                {
+                    printf("Sequence error at byte %lu: expected 0x%02X, got 0x%02X\n", received + i, expected, spans[s].data[i]);
+                    return EXIT_FAILURE;
+                }
+                expected++;
+            }
+        }
+        uart_consume(&rx, count);
+        received += count;
+    }
+    pthread_join(thread, NULL);
+    elapsed = now_s() - start;
+    printf("rxReserve/peek: %lu bytes in %.3f s (%.1f MB/s)\n", STRESS_BYTES, elapsed, (double)STRESS_BYTES / elapsed / 1e6);
+
+    // Backpressure: the producer is only throttled through the flow control callback
+    uart_setOverflowPolicy(&rx, UART_OVERFLOW_BACKPRESSURE, rx.rxSize * 3 / 4, rx.rxSize / 4, flow_control_cb);
+    received = 0;
+    start = now_s();
+    pthread_create(&thread, NULL, flow_controlled_producer, NULL);
+    while (received != STRESS_BYTES)
+    {
+        size_t count = uart_readAvailable(&rx, chunk, sizeof(chunk));
+        if (count == 0)
+        {
+            sched_yield();
+        }
+        for (size_t i = 0; i != count; i++, received++)
+        {
+            if (chunk[i] != expected)
+            {
+                printf("Sequence error at byte %lu: expected 0x%02X, got 0x%02X\n", received, expected, chunk[i]);
+                return EXIT_FAILURE;
+            }
+            expected++;
+        }
+    }
+    pthread_join(thread, NULL);
+    elapsed = now_s() - start;
+    printf("backpressure: %lu bytes in %.3f s (%.1f MB/s)\n", STRESS_BYTES, elapsed, (double)STRESS_BYTES / elapsed / 1e6);
+
+    // Overwrite policy with a producer that laps the reader while it copies: no torn byte may be returned
+    if (!overwrite_run("overwrite readAvailable", false, OVERWRITE_READ) ||
+        !overwrite_run("overwrite popByte", false, OVERWRITE_POP) ||
+        !overwrite_run("overwrite burst", true, OVERWRITE_READ) ||
+        !overwrite_run("overwrite getLine", false, OVERWRITE_LINE) ||
+        !overwrite_port_run())
+    {
+        return EXIT_FAILURE;
+    }
+    expected = next_byte;
+
+    // Blocking reads with deadline: the reader sleeps on a semaphore given by the "interrupt" after each publish
+    static sem_t rx_sem;
+    sem_init(&rx_sem, 0, 0);
+    uart_buffer_initStorage(&rx, rx_storage, sizeof(rx_storage), tx_storage, sizeof(tx_storage), write_cb, read_cb);
+    uart_setWaitHooks(&rx, now_us, rx_wait_cb, rx_wake_cb, &rx_sem);
+    received = 0;
+    start = now_s();
+    pthread_create(&thread, NULL, producer, NULL);
+    while (received != STRESS_BYTES)
+    {
+        size_t len = (STRESS_BYTES - received < sizeof(chunk)) ? (size_t)(STRESS_BYTES - received) : sizeof(chunk);
+        size_t count = uart_readBufferTimeout(&rx, chunk, len, 1000000);
+        if (count != len)
+        {
+            printf("readBufferTimeout: timeout at byte %lu\n", received + count);
+            return EXIT_FAILURE;
+        }
+        for (size_t i = 0; i != count; i++, received++)
+        {
+            if (chunk[i] != expected)
+            {
+                printf("Sequence error at byte %lu: expected 0x%02X, got 0x%02X\n", received, expected, chunk[i]);
+                return EXIT_FAILURE;
+            }
+            expected++;
+        }
+    }
+    pthread_join(thread, NULL);
+    elapsed = now_s() - start;
+    printf("readBufferTimeout: %lu bytes in %.3f s (%.1f MB/s)\n", STRESS_BYTES, elapsed, (double)STRESS_BYTES / elapsed / 1e6);
+
+    // Nothing else arrives: read must give up after its deadline, returning no data
+    start = now_s();
+    if (uart_readBufferTimeout(&rx, chunk, sizeof(chunk), 20000) != 0 || now_s() - start < 0.02)
+    {
+        printf("readBufferTimeout: deadline not honoured\n");
+        return EXIT_FAILURE;
+    }
+    uart_setWaitHooks(&rx, NULL, NULL, NULL, NULL);
+    sem_destroy(&rx_sem);
+
+    // TX ring: the main thread queues data, a second thread plays the TX-empty interrupt
+    uint8_t block[53];
+    uint8_t value = 0;
+    uart_txInit(&rx, tx_enable_cb, 115200);
+    start = now_s();
+    pthread_create(&thread, NULL, tx_interrupt, NULL);
+    for (unsigned long queued = 0; queued != STRESS_BYTES;)
+    {
+        size_t len = (STRESS_BYTES - queued < sizeof(block)) ? (size_t)(STRESS_BYTES - queued) : sizeof(block);
+        for (size_t i = 0; i != len; i++)
+        {
+            block[i] = value++;
+        }
+        for (size_t done = 0; done != len;)
+        {
+            size_t count = uart_writeAsync(&rx, block + done, len - done);
+            if (count == 0)
+            {
+                sched_yield();
+            }
+            done += count;
+        }
+        queued += len;
+    }
+    pthread_join(thread, NULL);
+    elapsed = now_s() - start;
+    if (tx_errors != 0 || uart_txPending(&rx) != 0)
+    {
+        printf("TX ring: %lu sequence errors, %u bytes left\n", tx_errors, (unsigned)uart_txPending(&rx));
+        return EXIT_FAILURE;
+    }
+    printf("writeAsync (TX ring): %lu bytes in %.3f s (%.1f MB/s)\n", STRESS_BYTES, elapsed, (double)STRESS_BYTES / elapsed / 1e6);
+    return EXIT_SUCCESS;
+}
@@ -6,6 +6,7 @@
 UARTBuffer buffer1, buffer2;
 uint8_t tx_buffer[4] = {0x30, 0x31, 0x32, 0x33};
 uint8_t rx_buffer[4];
+char line[12];
 
 
 uint8_t buffer_to_read[16];
@@ -45,16 +46,16 @@ int main(int argc, char const *argv[])
     uart_puts(&buffer2, "Hola culeros");
     printf("\n");
     printf("Emulating UART interrupt handler\n");
-    for (size_t i = 0; i != sizeof(rx_buffer); i++)
+    for (size_t i = 0; i != sizeof(line) - 1; i++)    // read_cb1 sends 0x00 up to 0x0A (LF)
     {
         uart_interruptHandler(&buffer1);
         Sleep(50);
     }
     printf("Gets\n");
-    uart_gets(&buffer1, rx_buffer, sizeof(rx_buffer));
-    for (size_t i = 0; i != sizeof(rx_buffer); i++)
+    uart_gets(&buffer1, line, sizeof(line));
+    for (size_t i = 0; i != sizeof(line) - 1; i++)
     {
-        printf("rxBuffer[%u]=0x%02X\n",i,rx_buffer[i]);
+        printf("line[%zu]=0x%02X\n",i,line[i]);
     }
     
     printf("\n");
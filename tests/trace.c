@@ -0,0 +1,158 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+#include "../src/uart_buffer.h"
+#include "../src/uart_trace.h"
+
+/*
+ * Trace test: UART buffer operations must leave the expected records (reception, reads, overrun, flush,
+ * transmission). Then two writer threads (standing for an ISR and a task) record numbered events into a
+ * small trace while the main thread drains it: records must come out uncorrupted and in order per writer,
+ * and every record must be either read or counted as lost.
+ */
+
+#define TRACE_RING      16
+#define TRACE_SLOTS     64
+#define TRACE_RECORDS   60000   // Per writer
+
+static UARTBuffer port;
+static uint8_t rx_storage[TRACE_RING];
+static uint8_t tx_storage[TRACE_RING];
+static UARTTraceSlot slots[TRACE_SLOTS];
+static UARTTrace trace;
+static volatile int writers_done = 0;
+
+void write_cb(uint8_t data)
+{
+    (void)data;
+}
+
+uint8_t read_cb()
+{
+    return 'x';
+}
+
+static void *writer(void *arg)
+{
+    uint8_t id = (uint8_t)(uintptr_t)arg;
+    for (uint32_t i = 0; i != TRACE_RECORDS; i++)
+    {
+        uart_traceRecord(&trace, id, UART_TRACE_RX, i);
+    }
+    __atomic_fetch_add(&writers_done, 1, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+int main(int argc, char const *argv[])
+{
+    (void)argc;
+    (void)argv;
+    UARTTraceRecord records[TRACE_SLOTS];
+    uint8_t data[TRACE_RING];
+    int failures = 0;
+
+    uart_traceInit(&trace, slots, TRACE_SLOTS, NULL);
+    uart_buffer_initStorage(&port, rx_storage, TRACE_RING, tx_storage, TRACE_RING, write_cb, read_cb);
+    uart_setTrace(&port, &trace, 7);
+    for (int i = 0; i != 3; i++)
+    {
+        uart_interruptHandler(&port);
+    }
+    uart_readAvailable(&port, data, sizeof(data));
+    for (int i = 0; i != TRACE_RING + 4; i++)
+    {
+        uart_interruptHandler(&port);
+    }
+    uart_printBuffer(&port);
+    uart_readAvailable(&port, data, sizeof(data));
+    uart_interruptHandler(&port);
+    uart_flushBuffer(&port);
+    uart_puts(&port, "AT\r");
+
+    static const uint8_t expected[][2] = {
+        {UART_TRACE_RX, 1}, {UART_TRACE_RX, 1}, {UART_TRACE_RX, 1}, {UART_TRACE_READ, 3},
+        {UART_TRACE_OVERRUN, 4}, {UART_TRACE_READ, TRACE_RING}, {UART_TRACE_RX, 1}, {UART_TRACE_FLUSH, 1},
+        {UART_TRACE_TX, 3},
+    };
+    size_t count = uart_traceRead(&trace, records, TRACE_SLOTS);
+    size_t want = sizeof(expected) / sizeof(expected[0]) + TRACE_RING + 4;
+    for (size_t i = 0, e = 0; i != count; i++)
+    {
+        // Records 4 to 23 come from the run that overflows the ring, one per byte
+        bool run = i >= 4 && i < 4 + TRACE_RING + 4;
+        if (!run && e == sizeof(expected) / sizeof(expected[0]))
+            break;      // Reported by the count check
+        uint8_t event = run ? UART_TRACE_RX : expected[e][0];
+        uint8_t value = run ? 1 : expected[e][1];
+        if (records[i].event != event || records[i].value != value || records[i].port != 7)
+        {
+            printf("trace: record %zu is event %u value %u\n", i, (unsigned)records[i].event, (unsigned)records[i].value);
+            failures++;
+            break;
+        }
+        e += run ? 0 : 1;
+    }
+    if (count != want)
+    {
+        printf("trace: %zu records, expected %zu\n", count, want);
+        failures++;
+    }
+    uart_setTrace(&port, NULL, 0);
+
+    // Concurrent writers, lagging reader
+    pthread_t threads[2];
+    uint32_t next[2] = {0, 0};
+    size_t read = 0;
+    uint32_t lostBefore = trace.lost;
+    for (uintptr_t i = 0; i != 2; i++)
+    {
+        pthread_create(&threads[i], NULL, writer, (void *)i);
+    }
+    while (true)
+    {
+        int done = __atomic_load_n(&writers_done, __ATOMIC_ACQUIRE);
+        while ((count = uart_traceRead(&trace, records, 8)) != 0)
+        {
+            for (size_t i = 0; i != count; i++)
+            {
+                uint8_t id = records[i].port;
+                if (id > 1 || records[i].event != UART_TRACE_RX || records[i].value < next[id])
+                {
+                    printf("trace: corrupted or out of order record (port %u value %u)\n", (unsigned)id, (unsigned)records[i].value);
+                    failures++;
+                    break;
+                }
+                next[id] = records[i].value + 1u;
+            }
+            read += count;
+        }
+        if (done == 2)
+            break;
+    }
+    for (int i = 0; i != 2; i++)
+    {
+        pthread_join(threads[i], NULL);
+    }
+    uint32_t lost = trace.lost - lostBefore;
+    if (read + lost != 2 * TRACE_RECORDS)
+    {
+        printf("trace: %zu read + %u lost != %u recorded\n", read, (unsigned)lost, 2 * TRACE_RECORDS);
+        failures++;
+    }
+
+    // Recording cost (what reception handlers pay per event)
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (uint32_t i = 0; i != 1000000; i++)
+    {
+        uart_traceRecord(&trace, 0, UART_TRACE_RX, 1);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double ns = ((double)(end.tv_sec - start.tv_sec) * 1e9 + (double)(end.tv_nsec - start.tv_nsec)) / 1e6;
+
+    printf("trace: %zu concurrent records read, %u lost, %.1f ns per record, %s\n", read, (unsigned)lost, ns, failures == 0 ? "ok" : "FAILED");
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}